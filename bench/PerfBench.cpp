@@ -0,0 +1,134 @@
+/** 
+  *  \file PerfBench.cpp
+  *  
+  * Runs some zipped kernels ('forEach', 'std::transform' and 'std::sort')
+  * next to the equivalent raw loops, and reports the time and the hardware
+  * counters per element. Run it on Linux to get the counters. If they are
+  * not accessible (see /proc/sys/kernel/perf_event_paranoid), only the
+  * time is reported.
+*/ 
+
+
+
+
+#include <bits/stdc++.h>
+
+#include "ZipIter/ZipIter.h"
+#include "ZipIter/PerfCounters.h"
+
+
+using namespace std;
+using namespace it;
+
+
+
+/// Number of elements of each column
+const size_t n = size_t(1) << 22;
+
+
+/// Keeps the compiler from throwing the results away
+volatile double sink;
+
+
+mt19937 rng(0);
+
+vector<vector<double>> columns(8, vector<double>(n));
+
+
+
+
+/// Sum of every column, using 'forEach' with K columns or a plain indexed loop
+template <size_t... Is>
+void zippedSum (index_sequence<Is...>)
+{
+    double sum = 0.0;
+
+    forEach(columns[Is]..., [&](auto... xs)
+    {
+        const auto& dummie = { (sum += xs, 0)... };
+    });
+
+    sink = sum;
+}
+
+template <size_t... Is>
+void rawSum (index_sequence<Is...>)
+{
+    double sum = 0.0;
+
+    for(size_t i = 0; i < n; ++i)
+    {
+        const auto& dummie = { (sum += columns[Is][i], 0)... };
+    }
+
+    sink = sum;
+}
+
+
+template <size_t K>
+void sumKernels ()
+{
+    string cols = to_string(K) + (K == 1 ? " column" : " columns");
+
+    perf::report(cout, "forEach " + cols, perf::measure([]{ zippedSum(make_index_sequence<K>()); }), n);
+    perf::report(cout, "raw loop " + cols, perf::measure([]{ rawSum(make_index_sequence<K>()); }), n);
+}
+
+
+
+
+int main ()
+{
+    for(auto& col : columns)
+        generate(col.begin(), col.end(), []{ return uniform_real_distribution<>(0.0, 1.0)(rng); });
+
+
+    /// Warming up the memory
+    rawSum(make_index_sequence<8>());
+
+
+    sumKernels<1>();
+    sumKernels<2>();
+    sumKernels<4>();
+    sumKernels<8>();
+
+    cout << "\n";
+
+
+
+    vector<double> out(n);
+
+    perf::report(cout, "transform zipped", perf::measure([&]
+    {
+        transform(ZIP_ALL(columns[0], columns[1], columns[2]), out.begin(), unZip([](double x, double y, double z)
+        {
+            return x * y + z;
+        }));
+    }), n);
+
+    perf::report(cout, "transform raw loop", perf::measure([&]
+    {
+        for(size_t i = 0; i < n; ++i)
+            out[i] = columns[0][i] * columns[1][i] + columns[2][i];
+    }), n);
+
+    cout << "\n";
+
+
+
+    vector<double> keys = columns[0], payload = columns[1];
+
+    vector<pair<double, double>> pairs(n);
+
+    for(size_t i = 0; i < n; ++i)
+        pairs[i] = make_pair(keys[i], payload[i]);
+
+
+    perf::report(cout, "sort zipped", perf::measure([&]{ sort(ZIP_ALL(keys, payload)); }), n);
+
+    perf::report(cout, "sort vector of pairs", perf::measure([&]{ sort(pairs.begin(), pairs.end()); }), n);
+
+
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ *  @file    Adjacent.h
+ *
+ *  @brief Sliding windows of K consecutive rows of a zipped range, for
+ *         stencils like differences and moving averages. Each row is read
+ *         once from a single cursor and kept in a small rotating buffer.
+ */
+
+
+
+#ifndef ADJACENT_ZIP_ITER_H
+#define ADJACENT_ZIP_ITER_H
+
+#include <array>
+#include <iterator>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/// Where each element of the flat tuple of a window comes from, and the resulting types
+template <class Row, std::size_t K, bool ColumnMajor, class = std::make_index_sequence< K * std::tuple_size<Row>::value >>
+struct AdjacentLayout;
+
+template <class Row, std::size_t K, bool ColumnMajor, std::size_t... Ms>
+struct AdjacentLayout< Row, K, ColumnMajor, std::index_sequence<Ms...> >
+{
+    static constexpr std::size_t numColumns = std::tuple_size<Row>::value;
+
+    static constexpr std::size_t rowOf (std::size_t m) { return ColumnMajor ? m % K : m / numColumns; }
+
+    static constexpr std::size_t columnOf (std::size_t m) { return ColumnMajor ? m / K : m % numColumns; }
+
+
+    using value_type = std::tuple< std::tuple_element_t< columnOf(Ms), Row >... >;
+
+    using reference = std::tuple< const std::tuple_element_t< columnOf(Ms), Row >&... >;
+};
+
+
+
+/** \class AdjacentIter
+  *
+  * Keeps a copy of the K rows of the current window in a ring buffer.
+  * Advancing reads a single new row over the oldest one and moves the start
+  * of the ring, so every row is read from the containers exactly once and
+  * no row is moved. Dereferencing gives a flat
+  * tuple of references to the buffered values, with all the columns of the
+  * first row, then of the second one, and so on (row major), or the K values
+  * of the first column, then of the second one, and so on (column major).
+  * The references point into the iterator itself, so it is an input iterator.
+*/
+template <std::size_t K, class ZipT, bool ColumnMajor>
+class AdjacentIter
+{
+public:
+
+    using Row = std::decay_t< typename ZipT::iterator::value_type >;
+
+    using Layout = AdjacentLayout< Row, K, ColumnMajor >;
+
+
+    using iterator_category = std::input_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = typename Layout::value_type;
+    using reference         = typename Layout::reference;
+    using pointer           = void;
+
+
+    AdjacentIter () = default;
+
+    AdjacentIter (typename ZipT::iterator next, std::size_t pos, std::size_t steps) : next(next), pos(pos), steps(steps)
+    {
+        if(pos < steps)
+            for(std::size_t j = 0; j < K; ++j, ++this->next)
+                rows[j] = *this->next;
+    }
+
+
+
+    reference operator * () const { return refs( std::make_index_sequence< std::tuple_size<value_type>::value >() ); }
+
+
+    AdjacentIter& operator ++ ()
+    {
+        if(++pos < steps)
+        {
+            rows[first] = *next;
+
+            first = first + 1 < K ? first + 1 : 0;
+
+            ++next;
+        }
+
+        return *this;
+    }
+
+    AdjacentIter operator ++ (int) { AdjacentIter temp{ *this }; ++*this; return temp; }
+
+
+    friend bool operator == (const AdjacentIter& a, const AdjacentIter& b) { return a.pos == b.pos; }
+    friend bool operator != (const AdjacentIter& a, const AdjacentIter& b) { return a.pos != b.pos; }
+
+
+
+private:
+
+    template <std::size_t... Ms>
+    reference refs (std::index_sequence<Ms...>) const
+    {
+        return reference( std::get< Layout::columnOf(Ms) >( rows[ (first + Layout::rowOf(Ms)) % K ] )... );
+    }
+
+
+    typename ZipT::iterator next;
+
+    std::size_t pos = 0, steps = 0;
+
+    /// Position in 'rows' of the first row of the window
+    std::size_t first = 0;
+
+    std::array<Row, K> rows;
+};
+
+
+
+/// The range of windows of K rows of a 'Zip'. There are 'size() - K + 1' of them, or none
+template <std::size_t K, class ZipT, bool ColumnMajor>
+class Adjacent
+{
+public:
+
+    static_assert(K > 0, "The windows must have at least one row");
+
+    using iterator = AdjacentIter< K, ZipT, ColumnMajor >;
+
+    using const_iterator = iterator;
+
+
+    Adjacent (ZipT zipped) : zipped(zipped), steps(zipped.size() >= K ? zipped.size() - K + 1 : 0) {}
+
+
+    iterator begin () const { return iterator(zipped.begin(), 0, steps); }
+
+    iterator end () const { return iterator(zipped.begin(), steps, steps); }
+
+    std::size_t size () const { return steps; }
+
+
+private:
+
+    ZipT zipped;
+
+    std::size_t steps;
+};
+
+} // namespace help
+
+
+
+
+/** Iterates over every K consecutive rows of 'zipped'. Each step gives a flat
+  * tuple with the elements of the K rows one row after the other, so it can
+  * be expanded with 'unZip':
+  *
+  *     for(auto tup : adjacent<2>(zip(t, x)))
+  *         unZip(tup, [&](double t0, double x0, double t1, double x1){ ... });
+  *
+  * The elements are references to copies of the rows, so they can not be
+  * used to write to the containers.
+*/
+template <std::size_t K, typename... Containers>
+auto adjacent (const Zip<Containers...>& zipped)
+{
+    return help::Adjacent< K, Zip<Containers...>, false >(zipped);
+}
+
+
+/** The same as 'adjacent', but the flat tuple has the K values of the first
+  * column, then the K values of the second one, and so on, which is the usual
+  * order of the arguments of a stencil over each column:
+  *
+  *     for(auto tup : window<3>(zip(x, y)))
+  *         unZip(tup, [&](double x0, double x1, double x2, double y0, double y1, double y2){ ... });
+*/
+template <std::size_t K, typename... Containers>
+auto window (const Zip<Containers...>& zipped)
+{
+    return help::Adjacent< K, Zip<Containers...>, true >(zipped);
+}
+
+
+} // namespace it
+
+
+
+#endif // ADJACENT_ZIP_ITER_H
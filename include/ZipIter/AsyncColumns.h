@@ -0,0 +1,598 @@
+/**
+ *  @file    AsyncColumns.h
+ *
+ *  @brief Reads columns stored in binary files (the raw values, one file
+ *         per column) in batches, with the reads of the next batches done
+ *         by background threads while the current one is processed. The
+ *         batches are given as zips, to a callback or, in C++20, through
+ *         a coroutine generator.
+ */
+
+
+
+#ifndef ASYNC_COLUMNS_ZIP_ITER_H
+#define ASYNC_COLUMNS_ZIP_ITER_H
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <condition_variable>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
+
+#if defined(__has_include)
+    #if __has_include(<coroutine>) && defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+        #include <coroutine>
+        #define ZIP_ITER_COROUTINES
+    #endif
+#endif
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/// How the columns are read: rows per batch, batches in flight and reading threads
+struct AsyncOptions
+{
+    std::size_t batchRows = 1 << 16;
+
+    std::size_t depth = 3;
+
+    std::size_t ioThreads = 2;
+};
+
+
+
+namespace help
+{
+
+/** \class ColumnFile
+  *
+  * A file opened for reads at given offsets from several threads at once.
+  * They are made with 'pread' where available, otherwise through a stream
+  * guarded by a mutex.
+*/
+class ColumnFile
+{
+public:
+
+    ColumnFile (const std::string& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+
+        fd = open(path.c_str(), O_RDONLY);
+
+        struct stat info;
+
+        if(fd < 0 || fstat(fd, &info) < 0)
+        {
+            if(fd >= 0)
+                close(fd);
+
+            throw std::runtime_error("Could not open " + path);
+        }
+
+        length = std::size_t(info.st_size);
+
+#else
+
+        in.open(path, std::ios::binary | std::ios::ate);
+
+        if(!in)
+            throw std::runtime_error("Could not open " + path);
+
+        length = std::size_t(in.tellg());
+
+#endif
+    }
+
+    ~ColumnFile ()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        close(fd);
+#endif
+    }
+
+
+    ColumnFile (const ColumnFile&) = delete;
+
+    ColumnFile& operator= (const ColumnFile&) = delete;
+
+
+
+    /// Reads 'bytes' bytes starting at 'offset' into 'dst'
+    void read (char* dst, std::size_t bytes, std::size_t offset) const
+    {
+#if defined(__unix__) || defined(__APPLE__)
+
+        while(bytes)
+        {
+            ssize_t got = pread(fd, dst, bytes, off_t(offset));
+
+            if(got < 0 && errno == EINTR)
+                continue;
+
+            if(got <= 0)
+                throw std::runtime_error("Could not read a column file");
+
+            dst += got, bytes -= std::size_t(got), offset += std::size_t(got);
+        }
+
+#else
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        in.seekg(std::streamoff(offset));
+
+        if(!in.read(dst, std::streamsize(bytes)))
+            throw std::runtime_error("Could not read a column file");
+
+#endif
+    }
+
+
+    std::size_t size () const { return length; }
+
+
+private:
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = -1;
+#else
+    mutable std::ifstream in;
+
+    mutable std::mutex mutex;
+#endif
+
+    std::size_t length = 0;
+};
+
+
+
+
+/** \class AsyncReader
+  *
+  * Keeps 'depth' batches of buffers. Reading a batch means one read task
+  * per column, run by a pool of 'ioThreads' threads. A batch is given to
+  * the consumer when all its columns are in, and as soon as the consumer
+  * asks for the next one, the buffers are reused to read the batch 'depth'
+  * positions ahead. So while a batch is processed, the next 'depth - 1'
+  * are being read.
+*/
+template <typename... Ts>
+class AsyncReader
+{
+public:
+
+    static_assert(std::is_same< std::integer_sequence< bool, true, std::is_trivially_copyable<Ts>::value... >,
+                                std::integer_sequence< bool, std::is_trivially_copyable<Ts>::value..., true > >::value,
+                  "The columns must be trivially copyable");
+
+
+    using Batch = Zip< std::vector<Ts>&... >;
+
+
+    AsyncReader (const std::array< std::string, sizeof...(Ts) >& paths, const AsyncOptions& options) :
+                 batchRows(std::max(options.batchRows, std::size_t(1))), slots(std::max(options.depth, std::size_t(1)))
+    {
+        constexpr std::size_t sizes[] = { sizeof(Ts)... };
+
+        for(std::size_t c = 0; c < paths.size(); ++c)
+        {
+            files.emplace_back(new ColumnFile(paths[c]));
+
+            rows = std::min(rows, files.back()->size() / sizes[c]);
+        }
+
+        numBatches = (rows + batchRows - 1) / batchRows;
+
+        for(auto& slot : slots)
+            reserve(slot.buffers, std::index_sequence_for<Ts...>());
+
+        for(std::size_t t = 0; t < std::max(options.ioThreads, std::size_t(1)); ++t)
+            threads.emplace_back([this]{ work(); });
+
+        for(std::size_t b = 0; b < std::min(numBatches, slots.size()); ++b)
+            schedule(b);
+    }
+
+
+    ~AsyncReader ()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            stop = true;
+        }
+
+        hasWork.notify_all();
+
+        for(auto& t : threads)
+            t.join();
+    }
+
+
+    AsyncReader (const AsyncReader&) = delete;
+
+    AsyncReader& operator= (const AsyncReader&) = delete;
+
+
+
+    /** Waits for the next batch, giving back the buffers of the current one.
+      * Returns false when there are no more batches. Rethrows the errors of the reads.
+    */
+    bool next ()
+    {
+        if(started && current + slots.size() < numBatches)
+            schedule(current + slots.size());
+
+        current += started;
+        started = true;
+
+        if(current >= numBatches)
+            return false;
+
+        Slot& slot = slots[current % slots.size()];
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        batchDone.wait(lock, [&]{ return !slot.pending || error; });
+
+        if(error)
+            std::rethrow_exception(error);
+
+        return true;
+    }
+
+
+    /// The current batch, valid until the next call to 'next'
+    Batch batch () { return batch(std::index_sequence_for<Ts...>()); }
+
+
+    std::size_t size () const { return rows; }
+
+
+
+private:
+
+    using Buffers = std::tuple< std::vector<Ts>... >;
+
+    struct Slot
+    {
+        Buffers buffers;
+
+        std::size_t pending = 0;
+    };
+
+    struct Task
+    {
+        char* dst;
+
+        std::size_t bytes, offset, column;
+
+        Slot* slot;
+    };
+
+
+
+    template <std::size_t... Is>
+    void reserve (Buffers& buffers, std::index_sequence<Is...>)
+    {
+        const auto& dummie = { ( std::get<Is>(buffers).resize(std::min(batchRows, rows)), int{} )... };
+    }
+
+    template <std::size_t... Is>
+    Batch batch (std::index_sequence<Is...>)
+    {
+        return Batch( std::get<Is>( slots[current % slots.size()].buffers )... );
+    }
+
+
+    /// Queues the reads of the batch 'b' into its slot
+    void schedule (std::size_t b)
+    {
+        schedule(b, std::index_sequence_for<Ts...>());
+
+        hasWork.notify_all();
+    }
+
+    template <std::size_t... Is>
+    void schedule (std::size_t b, std::index_sequence<Is...>)
+    {
+        Slot& slot = slots[b % slots.size()];
+
+        std::size_t first = b * batchRows, n = std::min(batchRows, rows - first);
+
+        const auto& dummie = { ( std::get<Is>(slot.buffers).resize(n), int{} )... };
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        slot.pending = sizeof...(Ts);
+
+        const auto& dummie2 = { ( tasks.push_back(Task{ reinterpret_cast<char*>(std::get<Is>(slot.buffers).data()), n * sizeof(Ts),
+                                                        first * sizeof(Ts), Is, &slot }), int{} )... };
+    }
+
+
+    void work ()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while(true)
+        {
+            hasWork.wait(lock, [&]{ return stop || !tasks.empty(); });
+
+            if(stop)
+                return;
+
+            Task task = tasks.front();
+
+            tasks.pop_front();
+
+            lock.unlock();
+
+            std::exception_ptr failure;
+
+            try
+            {
+                files[task.column]->read(task.dst, task.bytes, task.offset);
+            }
+
+            catch(...)
+            {
+                failure = std::current_exception();
+            }
+
+            lock.lock();
+
+            if(failure && !error)
+                error = failure;
+
+            if(!--task.slot->pending || failure)
+                batchDone.notify_all();
+        }
+    }
+
+
+
+    std::size_t batchRows, rows = std::size_t(-1), numBatches = 0;
+
+    std::size_t current = 0;
+
+    bool started = false;
+
+    std::vector< std::unique_ptr<ColumnFile> > files;
+
+    std::vector<Slot> slots;
+
+
+    std::mutex mutex;
+
+    std::condition_variable hasWork, batchDone;
+
+    std::deque<Task> tasks;
+
+    std::exception_ptr error;
+
+    bool stop = false;
+
+    std::vector<std::thread> threads;
+};
+
+
+
+
+#if defined(ZIP_ITER_COROUTINES)
+
+/** \class Generator
+  *
+  * A minimal C++20 generator: a coroutine that 'co_yield's values of type
+  * T, consumed with a range for loop. The values are not copied, the loop
+  * sees the object yielded until the coroutine is resumed.
+*/
+template <typename T>
+class Generator
+{
+public:
+
+    struct promise_type
+    {
+        Generator get_return_object () { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        std::suspend_always initial_suspend () noexcept { return {}; }
+
+        std::suspend_always final_suspend () noexcept { return {}; }
+
+        std::suspend_always yield_value (T& value) noexcept { current = std::addressof(value); return {}; }
+
+        std::suspend_always yield_value (T&& value) noexcept { current = std::addressof(value); return {}; }
+
+        void return_void () {}
+
+        void unhandled_exception () { error = std::current_exception(); }
+
+
+        T* current = nullptr;
+
+        std::exception_ptr error;
+    };
+
+
+    class iterator
+    {
+    public:
+
+        iterator (std::coroutine_handle<promise_type> handle = nullptr) : handle(handle) {}
+
+        iterator& operator ++ () { resume(handle); return *this; }
+
+        T& operator * () const { return *handle.promise().current; }
+
+        friend bool operator == (const iterator& it, std::default_sentinel_t) { return !it.handle || it.handle.done(); }
+
+    private:
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+
+    Generator (Generator&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    Generator& operator= (Generator&&) = delete;
+
+    ~Generator ()
+    {
+        if(handle)
+            handle.destroy();
+    }
+
+
+    iterator begin () { resume(handle); return iterator(handle); }
+
+    std::default_sentinel_t end () { return {}; }
+
+
+private:
+
+    explicit Generator (std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    static void resume (std::coroutine_handle<promise_type> handle)
+    {
+        handle.resume();
+
+        if(handle.promise().error)
+            std::rethrow_exception(handle.promise().error);
+    }
+
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+#endif
+
+} // namespace help
+
+
+
+
+/** \class AsyncColumns
+  *
+  * A source of batches of columns read from binary files, each holding
+  * the raw values of a single column of type 'Ts' (as written by
+  * 'fwrite(column.data(), sizeof(T), n, file)'). The number of rows is
+  * the one of the shortest file. Each pass over the batches opens the
+  * files and starts its own reading threads, which end with the pass.
+  *
+  * 'forEachBatch' calls a function with each batch, and with coroutine
+  * support (C++20), 'batches' gives them to a range for loop. A batch is
+  * a 'Zip' of std::vector's holding the rows of that batch, which can be
+  * modified freely but are reused for a later batch once the next one is taken.
+*/
+template <typename... Ts>
+class AsyncColumns
+{
+public:
+
+    using Batch = typename help::AsyncReader<Ts...>::Batch;
+
+
+    AsyncColumns (std::array< std::string, sizeof...(Ts) > paths, AsyncOptions options = AsyncOptions()) :
+                  paths(std::move(paths)), options(options) {}
+
+
+
+    /** Calls 'f(batch)' for each batch, in order, with the reads of the next
+      * batches overlapping the call. Returns the total number of rows.
+    */
+    template <class F>
+    std::size_t forEachBatch (F f) const
+    {
+        help::AsyncReader<Ts...> reader(paths, options);
+
+        while(reader.next())
+            f(reader.batch());
+
+        return reader.size();
+    }
+
+
+#if defined(ZIP_ITER_COROUTINES)
+
+    /** The batches as a coroutine generator: 'for(auto& batch : columns.batches()) ...'.
+      * The generator keeps its own copy of the paths and options, so it can
+      * outlive 'this', as in 'for(auto& batch : asyncColumns<int>("a.bin").batches())'.
+    */
+    help::Generator<Batch> batches () const { return batches(paths, options); }
+
+#endif
+
+
+private:
+
+#if defined(ZIP_ITER_COROUTINES)
+
+    static help::Generator<Batch> batches (std::array< std::string, sizeof...(Ts) > paths, AsyncOptions options)
+    {
+        help::AsyncReader<Ts...> reader(paths, options);
+
+        while(reader.next())
+            co_yield reader.batch();
+    }
+
+#endif
+
+
+    std::array< std::string, sizeof...(Ts) > paths;
+
+    AsyncOptions options;
+};
+
+
+
+
+/** Reads the files 'paths', one per column of type 'Ts', asynchronously in batches:
+  *
+  *     asyncColumns<double, int>(options, "price.bin", "qty.bin").forEachBatch([&](auto batch)
+  *     {
+  *         forEach(batch, [&](double price, int qty){ total += price * qty; });
+  *     });
+*/
+template <typename... Ts, typename... Paths>
+AsyncColumns<Ts...> asyncColumns (const AsyncOptions& options, const Paths&... paths)
+{
+    static_assert(sizeof...(Ts) == sizeof...(Paths), "There must be one file for each column");
+
+    return AsyncColumns<Ts...>({{ std::string(paths)... }}, options);
+}
+
+template <typename... Ts, typename... Paths>
+AsyncColumns<Ts...> asyncColumns (const std::string& path, const Paths&... paths)
+{
+    return asyncColumns<Ts...>(AsyncOptions(), path, paths...);
+}
+
+
+} // namespace it
+
+
+
+#endif // ASYNC_COLUMNS_ZIP_ITER_H
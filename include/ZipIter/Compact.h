@@ -0,0 +1,145 @@
+/**
+ *  @file    Compact.h
+ *
+ *  @brief Removal of rows from zipped columns ('std::remove_if' and
+ *         'std::unique'), done one column at a time after a selection
+ *         mask is computed, instead of moving tuples row by row.
+ */
+
+
+
+#ifndef COMPACT_ZIP_ITER_H
+#define COMPACT_ZIP_ITER_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/** Left packs the rows of a column marked in 'keep', starting at 'start'
+  * (every row before it is kept). For trivially copyable types the store
+  * is always made and only the output position depends on the mask, so
+  * there is no branch to mispredict.
+*/
+template <class Iter>
+std::size_t compactColumn (Iter first, const std::vector<std::uint8_t>& keep, std::size_t start, std::true_type)
+{
+    std::size_t j = start, n = keep.size();
+
+    for(std::size_t i = start; i < n; ++i)
+    {
+        first[j] = first[i];
+
+        j += keep[i];
+    }
+
+    return j;
+}
+
+/// Other types are moved only when needed, so move only types work too
+template <class Iter>
+std::size_t compactColumn (Iter first, const std::vector<std::uint8_t>& keep, std::size_t start, std::false_type)
+{
+    std::size_t j = start, n = keep.size();
+
+    for(std::size_t i = start; i < n; ++i) if(keep[i])
+        first[j++] = std::move(first[i]);
+
+    return j;
+}
+
+template <class Iter>
+std::size_t compactColumn (Iter first, const std::vector<std::uint8_t>& keep, std::size_t start)
+{
+    return compactColumn(first, keep, start, std::is_trivially_copyable< typename std::iterator_traits<Iter>::value_type >());
+}
+
+
+template <class ZipT, std::size_t... Is>
+std::size_t compactRows (ZipT& zipped, const std::vector<std::uint8_t>& keep, std::index_sequence<Is...>)
+{
+    std::size_t start = std::find(keep.begin(), keep.end(), 0) - keep.begin(), size = start;
+
+    if(start == keep.size())
+        return start;
+
+    const auto& dummie = { ( size = compactColumn( help::begin( zipped.template get<Is>() ), keep, start ), int{} )... };
+
+    return size;
+}
+
+
+template <class ZipT, class Equal>
+std::size_t uniqueRows (ZipT& zipped, Equal equal)
+{
+    constexpr auto seq = std::make_index_sequence< ZipT::containersSize >();
+
+    std::vector<std::uint8_t> keep(zipped.size(), 1);
+
+    for(std::size_t i = 1; i < keep.size(); ++i)
+        keep[i] = !equal(rowAt(zipped, i - 1, seq), rowAt(zipped, i, seq));
+
+    return compactRows(zipped, keep, seq);
+}
+
+} // namespace help
+
+
+
+
+/** The same as 'std::remove_if(ZIP_ALL(...), unZip(pred))'. The predicate
+  * receives the elements of a row unpacked, and is evaluated for every row
+  * before anything is moved. Then each column is compacted separately.
+  * Returns the new number of rows. As in 'std::remove_if', the containers
+  * are not resized and the rows after the new end are left in a valid but
+  * unspecified state. The containers must be random access.
+*/
+template <typename... Containers, class Predicate>
+std::size_t compact (Zip<Containers...> zipped, Predicate pred)
+{
+    constexpr auto seq = std::make_index_sequence< sizeof...(Containers) >();
+
+    std::vector<std::uint8_t> keep(zipped.size());
+
+    for(std::size_t i = 0; i < keep.size(); ++i)
+        keep[i] = !unZip(help::rowAt(zipped, i, seq), pred);
+
+    return help::compactRows(zipped, keep, seq);
+}
+
+
+
+/** The same as 'std::unique(ZIP_ALL(...), unZip(equal))', removing every
+  * row that is equal to the previous one. The 'equal' function receives
+  * the elements of both rows unpacked, as in the comparisons of 'std::sort'.
+  * It must be an equivalence relation. The default compares all columns.
+*/
+template <typename... Containers, class Equal>
+std::size_t unique (Zip<Containers...> zipped, Equal equal)
+{
+    return help::uniqueRows(zipped, [&](const auto& row1, const auto& row2){ return UnZip<Equal>(equal)(row1, row2); });
+}
+
+template <typename... Containers>
+std::size_t unique (Zip<Containers...> zipped)
+{
+    return help::uniqueRows(zipped, [](const auto& row1, const auto& row2){ return row1 == row2; });
+}
+
+
+} // namespace it
+
+
+
+#endif // COMPACT_ZIP_ITER_H
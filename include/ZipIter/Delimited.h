@@ -0,0 +1,451 @@
+/**
+ *  @file    Delimited.h
+ *
+ *  @brief Parsing of delimited text (CSV and similar) straight into
+ *         columns, without row structs in between. The input is cut at
+ *         line boundaries and the chunks are parsed in parallel, each one
+ *         writing to its own rows of the output columns.
+ */
+
+
+
+#ifndef DELIMITED_ZIP_ITER_H
+#define DELIMITED_ZIP_ITER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <numeric>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/// The delimiter, whether the first line is a header to skip, and the number of threads
+struct DelimitedOptions
+{
+    char delimiter = ',';
+
+    bool header = false;
+
+    std::size_t numThreads = 1;
+};
+
+
+
+
+namespace help
+{
+
+/** \class MappedFile
+  *
+  * A read only view of a whole file. It is memory mapped where possible,
+  * otherwise the file is read into a buffer.
+*/
+class MappedFile
+{
+public:
+
+    MappedFile (const std::string& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+
+        int fd = open(path.c_str(), O_RDONLY);
+
+        struct stat info;
+
+        if(fd < 0 || fstat(fd, &info) < 0)
+        {
+            if(fd >= 0)
+                close(fd);
+
+            throw std::runtime_error("Could not open " + path);
+        }
+
+        length = std::size_t(info.st_size);
+
+        if(length)
+        {
+            void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if(map != MAP_FAILED)
+            {
+                mapped = static_cast<const char*>(map);
+
+                madvise(map, length, MADV_SEQUENTIAL);
+            }
+        }
+
+        close(fd);
+
+        if(mapped || !length)
+            return;
+#endif
+
+        std::ifstream in(path, std::ios::binary);
+
+        if(!in)
+            throw std::runtime_error("Could not open " + path);
+
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+        length = buffer.size();
+    }
+
+
+    ~MappedFile ()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if(mapped)
+            munmap(const_cast<char*>(mapped), length);
+#endif
+    }
+
+
+    MappedFile (const MappedFile&) = delete;
+
+    MappedFile& operator= (const MappedFile&) = delete;
+
+
+
+    const char* data () const { return mapped ? mapped : buffer.data(); }
+
+    std::size_t size () const { return length; }
+
+
+private:
+
+    const char* mapped = nullptr;
+
+    std::size_t length = 0;
+
+    std::vector<char> buffer;
+};
+
+
+
+
+/// Integers are parsed by hand, rejecting overflow and any character other than digits
+template <typename T, std::enable_if_t< std::is_integral<T>::value, int > = 0>
+bool parseField (const char* first, const char* last, T& value)
+{
+    bool negative = first != last && *first == '-';
+
+    if(first != last && (*first == '-' || *first == '+'))
+        ++first;
+
+    if(first == last || (negative && !std::is_signed<T>::value))
+        return false;
+
+
+    const std::uint64_t limit = std::uint64_t(std::numeric_limits<T>::max()) + negative;
+
+    std::uint64_t u = 0;
+
+    for(; first != last; ++first)
+    {
+        unsigned digit = unsigned(*first) - '0';
+
+        if(digit > 9 || u > (limit - digit) / 10)
+            return false;
+
+        u = 10 * u + digit;
+    }
+
+    value = negative ? T(0 - u) : T(u);
+
+    return true;
+}
+
+
+inline void toFloat (const char* str, char** end, float& value)       { value = std::strtof(str, end); }
+inline void toFloat (const char* str, char** end, double& value)      { value = std::strtod(str, end); }
+inline void toFloat (const char* str, char** end, long double& value) { value = std::strtold(str, end); }
+
+/// 'strtod' needs a null terminated string, so the field is copied first
+template <typename T, std::enable_if_t< std::is_floating_point<T>::value, int > = 0>
+bool parseField (const char* first, const char* last, T& value)
+{
+    char str[64];
+
+    std::size_t length = last - first;
+
+    if(!length || length >= sizeof(str))
+        return false;
+
+    std::memcpy(str, first, length);
+    str[length] = '\0';
+
+    char* end;
+
+    toFloat(str, &end, value);
+
+    return end == str + length;
+}
+
+inline bool parseField (const char* first, const char* last, std::string& value)
+{
+    value.assign(first, last);
+
+    return true;
+}
+
+
+
+/** Calls 'f(first, last, line)' for each non empty line in [first, last), without
+  * the line break, where 'line' counts the empty lines too. Returns the number of lines.
+*/
+template <class F>
+std::size_t forEachLine (const char* first, const char* last, F f)
+{
+    std::size_t line = 0;
+
+    for(; first < last; ++line)
+    {
+        const char* end = static_cast<const char*>(std::memchr(first, '\n', last - first));
+
+        if(!end)
+            end = last;
+
+        const char* stop = end != first && end[-1] == '\r' ? end - 1 : end;
+
+        if(stop != first)
+            f(first, stop, line);
+
+        first = end + 1;
+    }
+
+    return line;
+}
+
+
+
+/** Parses the fields of a line into the given row of the columns. Fields after the last
+  * column are ignored. 'line' is the number of the line in the input, for the errors.
+*/
+template <class ZipT, std::size_t... Is>
+void parseLine (const char* first, const char* last, char delimiter, const ZipT& columns, std::size_t row, std::size_t line, std::index_sequence<Is...>)
+{
+    const char* text = first;
+
+    bool ok = true;
+
+    const auto& dummie = { ( ok = ok && [&]
+    {
+        if(first > last)
+            return false;
+
+        const char* end = static_cast<const char*>(std::memchr(first, delimiter, last - first));
+
+        if(!end)
+            end = last;
+
+        bool parsed = parseField(first, end, help::begin(columns.template get<Is>())[row]);
+
+        first = end + 1;
+
+        return parsed;
+
+    }(), int{} )... };
+
+    if(!ok)
+        throw std::runtime_error("Could not parse the line " + std::to_string(line) + ": " + std::string(text, last));
+}
+
+
+
+template <typename... Ts, std::size_t... Is>
+std::tuple< std::vector< Ts >&... > tieColumns (std::tuple< std::vector< Ts >... >& columns, std::index_sequence<Is...>)
+{
+    return std::tie(std::get<Is>(columns)...);
+}
+
+
+/** Cuts the input in chunks starting right after a line break. Every chunk
+  * counts its lines, which gives the row where each one starts, and then all
+  * of them parse their lines in parallel, directly into the resized columns.
+  * If a line can not be parsed, the columns are shrunk back to their old size.
+*/
+template <typename... Ts, std::size_t... Is>
+std::size_t parseDelimited (const char* data, std::size_t size, const DelimitedOptions& options,
+                            std::tuple< std::vector< Ts >&... > columns, std::index_sequence<Is...>)
+{
+    static_assert(sizeof...(Ts) > 0, "There must be at least one column");
+
+    static_assert(std::is_same< std::integer_sequence< bool, false, std::is_same<Ts, bool>::value... >,
+                                std::integer_sequence< bool, std::is_same<Ts, bool>::value..., false > >::value,
+                  "std::vector<bool> can not be written by many threads, use char columns instead");
+
+
+    const char* first = data, *last = data + size;
+
+    if(options.header)
+    {
+        const char* end = size ? static_cast<const char*>(std::memchr(first, '\n', size)) : nullptr;
+
+        first = end ? end + 1 : last;
+    }
+
+
+    std::size_t numThreads = std::max(std::size_t(1), std::min(options.numThreads, std::size_t(last - first) / 4096 + 1));
+
+    std::vector<const char*> bounds(numThreads + 1, last);
+
+    bounds[0] = first;
+
+    /// Each chunk has at least 4096 bytes, so every 'p' is after 'first'
+    for(std::size_t t = 1; t < numThreads; ++t)
+    {
+        const char* p = first + (last - first) * t / numThreads;
+        const char* end = static_cast<const char*>(std::memchr(p - 1, '\n', last - p + 1));
+
+        bounds[t] = std::max(bounds[t-1], end ? end + 1 : last);
+    }
+
+
+    /// The rows and the lines (empty ones included) before each chunk, once summed
+    std::vector<std::size_t> rows(numThreads + 1, 0), lines(numThreads + 1, 0);
+    std::vector<std::exception_ptr> errors(numThreads);
+
+    auto parallel = [&](auto f)
+    {
+        std::vector<std::thread> threads;
+
+        auto run = [&](std::size_t t)
+        {
+            try { f(t); }
+
+            catch(...) { errors[t] = std::current_exception(); }
+        };
+
+        for(std::size_t t = 1; t < numThreads; ++t)
+            threads.emplace_back(run, t);
+
+        run(0);
+
+        for(auto& thread : threads)
+            thread.join();
+
+        for(auto& error : errors)
+            if(error)
+                std::rethrow_exception(error);
+    };
+
+
+    parallel([&](std::size_t t)
+    {
+        lines[t+1] = forEachLine(bounds[t], bounds[t+1], [&](const char*, const char*, std::size_t){ ++rows[t+1]; });
+    });
+
+    rows[0] = std::get<0>(columns).size();
+    lines[0] = options.header ? 2 : 1;
+
+    std::partial_sum(rows.begin(), rows.end(), rows.begin());
+    std::partial_sum(lines.begin(), lines.end(), lines.begin());
+
+    const auto& dummie = { ( std::get<Is>(columns).resize(rows.back()), int{} )... };
+
+
+    auto zipped = zip(std::get<Is>(columns)...);
+
+    try
+    {
+        parallel([&](std::size_t t)
+        {
+            std::size_t row = rows[t];
+
+            forEachLine(bounds[t], bounds[t+1], [&](const char* b, const char* e, std::size_t line)
+            {
+                parseLine(b, e, options.delimiter, zipped, row++, lines[t] + line, std::index_sequence<Is...>());
+            });
+        });
+    }
+
+    catch(...)
+    {
+        const auto& dummie2 = { ( std::get<Is>(columns).resize(rows[0]), int{} )... };
+
+        throw;
+    }
+
+    return rows.back() - rows[0];
+}
+
+} // namespace help
+
+
+
+
+/** Parses delimited text in 'data' and appends one row to the columns for
+  * each non empty line, returning the number of rows added. The first fields
+  * of each line go to the columns, in order, and any other field is ignored.
+  * The columns can be integers, floating point numbers or std::string's, and
+  * there is no quoting. Delimiters and line breaks (with an optional '\r') are
+  * found with 'memchr'. The input is cut at line breaks in 'numThreads' chunks,
+  * whose rows are counted first, so each chunk is then parsed straight into its
+  * own rows of the columns. Throws std::runtime_error on a malformed line,
+  * giving its line number in the input, and then the columns are left as
+  * they were before the call.
+*/
+template <typename... Ts>
+std::size_t parseDelimited (const char* data, std::size_t size, const DelimitedOptions& options, std::vector<Ts>&... columns)
+{
+    return help::parseDelimited(data, size, options, std::tuple< std::vector< Ts >&... >(columns...), std::index_sequence_for<Ts...>());
+}
+
+
+/// Parses delimited text into a tuple of new std::vector's of the given types
+template <typename... Ts>
+std::tuple< std::vector< Ts >... > parseDelimited (const char* data, std::size_t size, const DelimitedOptions& options = DelimitedOptions())
+{
+    std::tuple< std::vector< Ts >... > res;
+
+    help::parseDelimited(data, size, options, help::tieColumns(res, std::index_sequence_for<Ts...>()), std::index_sequence_for<Ts...>());
+
+    return res;
+}
+
+
+
+/// The same for a file, which is memory mapped
+template <typename... Ts>
+std::size_t parseDelimitedFile (const std::string& path, const DelimitedOptions& options, std::vector<Ts>&... columns)
+{
+    help::MappedFile file(path);
+
+    return parseDelimited(file.data(), file.size(), options, columns...);
+}
+
+
+template <typename... Ts>
+std::tuple< std::vector< Ts >... > parseDelimitedFile (const std::string& path, const DelimitedOptions& options = DelimitedOptions())
+{
+    help::MappedFile file(path);
+
+    return parseDelimited<Ts...>(file.data(), file.size(), options);
+}
+
+
+} // namespace it
+
+
+
+#endif // DELIMITED_ZIP_ITER_H
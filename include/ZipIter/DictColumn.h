@@ -0,0 +1,324 @@
+/**
+ *  @file    DictColumn.h
+ *
+ *  @brief A dictionary encoded column for data with few distinct values:
+ *         small integer codes per row plus the list of distinct values.
+ *         It zips as a column of values, while grouping, filtering and
+ *         sorting can work on the codes alone.
+ */
+
+
+
+#ifndef DICT_COLUMN_ZIP_ITER_H
+#define DICT_COLUMN_ZIP_ITER_H
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <numeric>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+
+#include "ZipIter.h"
+#include "HashIndex.h"
+#include "ScratchArena.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/** \class DictColumnIter
+  *
+  * Random access iterator over a 'DictColumn', giving a const reference to
+  * the dictionary entry of each row. The values can not be assigned through it.
+*/
+template <class Column>
+class DictColumnIter
+{
+public:
+
+    using iterator_category = std::random_access_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = typename std::remove_const_t<Column>::value_type;
+    using reference         = const value_type&;
+    using pointer           = const value_type*;
+
+
+    DictColumnIter () = default;
+
+    DictColumnIter (Column* column, std::size_t pos) : col(column), pos(pos) {}
+
+
+
+    reference operator * () const { return (*col)[pos]; }
+
+    pointer operator -> () const { return &(*col)[pos]; }
+
+    reference operator [] (difference_type inc) const { return (*col)[pos + inc]; }
+
+
+    DictColumnIter& operator ++ () { ++pos; return *this; }
+    DictColumnIter& operator -- () { --pos; return *this; }
+
+    DictColumnIter operator ++ (int) { DictColumnIter temp{ *this }; ++pos; return temp; }
+    DictColumnIter operator -- (int) { DictColumnIter temp{ *this }; --pos; return temp; }
+
+    DictColumnIter& operator += (difference_type inc) { pos += inc; return *this; }
+    DictColumnIter& operator -= (difference_type inc) { pos -= inc; return *this; }
+
+
+    friend DictColumnIter operator + (DictColumnIter it, difference_type inc) { return it += inc; }
+    friend DictColumnIter operator + (difference_type inc, DictColumnIter it) { return it += inc; }
+    friend DictColumnIter operator - (DictColumnIter it, difference_type inc) { return it -= inc; }
+
+    friend difference_type operator - (const DictColumnIter& a, const DictColumnIter& b) { return difference_type(a.pos) - difference_type(b.pos); }
+
+
+    friend bool operator == (const DictColumnIter& a, const DictColumnIter& b) { return a.pos == b.pos; }
+    friend bool operator != (const DictColumnIter& a, const DictColumnIter& b) { return a.pos != b.pos; }
+    friend bool operator <  (const DictColumnIter& a, const DictColumnIter& b) { return a.pos <  b.pos; }
+    friend bool operator >  (const DictColumnIter& a, const DictColumnIter& b) { return a.pos >  b.pos; }
+    friend bool operator <= (const DictColumnIter& a, const DictColumnIter& b) { return a.pos <= b.pos; }
+    friend bool operator >= (const DictColumnIter& a, const DictColumnIter& b) { return a.pos >= b.pos; }
+
+
+    Column& column () const { return *col; }
+
+
+private:
+
+    Column* col = nullptr;
+
+    std::size_t pos = 0;
+};
+
+} // namespace help
+
+
+
+
+/** \class DictColumn
+  *
+  * Every row holds a code of type 'Code' (one byte by default), the index
+  * of its value in the dictionary of distinct values. The dictionary is a
+  * 'HashIndex', so appending a value costs a single probe, and the codes
+  * are given in order of first appearance.
+  *
+  * Passed to 'zip', it behaves as a read only column of 'T'. The codes are
+  * a plain std::vector ('codes()'), so they can be zipped instead to run
+  * 'groupBy', equality filters ('find' gives the code to compare with) and
+  * sorts on 1 byte keys. After 'sortDictionary', the order of the codes is
+  * the order of the values, and sorting by code is sorting by value.
+*/
+template <typename T, typename Code = std::uint8_t>
+class DictColumn
+{
+public:
+
+    static_assert(std::is_integral<Code>::value && std::is_unsigned<Code>::value, "The codes must be unsigned integers");
+
+
+    using value_type = T;
+
+    using code_type = Code;
+
+    using iterator = help::DictColumnIter< DictColumn >;
+
+    using const_iterator = help::DictColumnIter< const DictColumn >;
+
+
+    /// Returned by 'find' when the value is not in the dictionary
+    static constexpr std::size_t npos = std::size_t(-1);
+
+    /// The maximum number of distinct values, saturated for codes as wide as std::size_t
+    static constexpr std::size_t maxValues = std::uint64_t(std::numeric_limits<Code>::max()) >= std::numeric_limits<std::size_t>::max() ?
+                                             std::numeric_limits<std::size_t>::max() : std::size_t(std::numeric_limits<Code>::max()) + 1;
+
+
+
+    DictColumn () = default;
+
+    DictColumn (std::initializer_list<T> values)
+    {
+        for(const auto& v : values)
+            push_back(v);
+    }
+
+    template <class Iter>
+    DictColumn (Iter first, Iter last)
+    {
+        for(; first != last; ++first)
+            push_back(*first);
+    }
+
+
+
+    void reserve (std::size_t rows) { codeList.reserve(rows); }
+
+
+    void push_back (const T& value) { codeList.push_back(encode(value)); }
+
+
+    /** The code of 'value', adding it to the dictionary if it is new. Throws
+      * if the dictionary is full, leaving it unchanged
+    */
+    Code encode (const T& value)
+    {
+        std::size_t h = dict.hash(value), code = dict.find(value, h);
+
+        if(code != npos)
+            return Code(code);
+
+        if(dict.size() >= maxValues)
+            throw std::runtime_error("Too many distinct values for the code type of the dictionary");
+
+        isSorted = false;
+
+        return Code(dict.insert(value, h).first);
+    }
+
+
+    /// The code of 'value', or 'npos' if no row has it
+    std::size_t find (const T& value) const { return dict.find(value); }
+
+
+    const T& decode (Code code) const { return dict.keys()[code]; }
+
+
+    void clear ()
+    {
+        codeList.clear();
+        dict = HashIndex<T>();
+        isSorted = true;
+    }
+
+
+
+    const T& operator [] (std::size_t pos) const { return dict.keys()[codeList[pos]]; }
+
+
+    iterator begin () { return iterator(this, 0); }
+
+    iterator end () { return iterator(this, size()); }
+
+    const_iterator begin () const { return const_iterator(this, 0); }
+
+    const_iterator end () const { return const_iterator(this, size()); }
+
+
+    std::size_t size () const { return codeList.size(); }
+
+    bool empty () const { return codeList.empty(); }
+
+    /// Number of distinct values
+    std::size_t cardinality () const { return dict.size(); }
+
+
+    /// The code of each row. They can be modified, as long as they stay below 'cardinality()'
+    std::vector<Code>& codes () { return codeList; }
+
+    const std::vector<Code>& codes () const { return codeList; }
+
+    /// The distinct values, indexed by code
+    const std::vector<T>& dictionary () const { return dict.keys(); }
+
+
+
+    /** Renumbers the codes so their order is the order of the values given
+      * by 'compare', rewriting the code of every row.
+    */
+    template <class Compare = std::less<>>
+    void sortDictionary (Compare compare = Compare())
+    {
+        const auto& keys = dict.keys();
+
+        std::vector<std::size_t> order(keys.size());
+
+        std::iota(order.begin(), order.end(), std::size_t(0));
+
+        std::sort(order.begin(), order.end(), [&](std::size_t i, std::size_t j){ return compare(keys[i], keys[j]); });
+
+        std::vector<Code> recode(order.size());
+
+        HashIndex<T> sortedDict(order.size());
+
+        for(std::size_t k = 0; k < order.size(); ++k)
+        {
+            recode[order[k]] = Code(k);
+            sortedDict.insert(keys[order[k]]);
+        }
+
+        for(auto& c : codeList)
+            c = recode[c];
+
+        dict = std::move(sortedDict);
+
+        isSorted = true;
+    }
+
+
+    /// Whether the code order is the value order, which appending a new value breaks
+    bool sorted () const { return isSorted; }
+
+
+
+private:
+
+    std::vector<Code> codeList;
+
+    HashIndex<T> dict;
+
+    bool isSorted = true;
+};
+
+
+template <typename T, typename Code>
+constexpr std::size_t DictColumn<T, Code>::npos;
+
+template <typename T, typename Code>
+constexpr std::size_t DictColumn<T, Code>::maxValues;
+
+
+
+
+namespace help
+{
+
+/// The algorithms of 'ScratchArena.h' permute only the codes of a 'DictColumn'
+template <typename T, typename Code>
+void permuteColumn (DictColumnIter< DictColumn<T, Code> > column, const std::size_t* perm, std::size_t n, ScratchArena& arena)
+{
+    permuteColumn(column.column().codes().begin(), perm, n, arena);
+}
+
+} // namespace help
+
+
+
+
+/** Dictionary encodes 'values' with codes of type 'Code'. The dictionary
+  * is sorted, so the codes can be compared in place of the values.
+*/
+template <typename Code = std::uint8_t, class Container>
+auto makeDictColumn (const Container& values)
+{
+    DictColumn< std::decay_t< decltype( *help::begin(values) ) >, Code > column(help::begin(values), help::end(values));
+
+    column.sortDictionary();
+
+    return column;
+}
+
+
+} // namespace it
+
+
+
+#endif // DICT_COLUMN_ZIP_ITER_H
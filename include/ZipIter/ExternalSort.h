@@ -0,0 +1,408 @@
+/**
+ *  @file    ExternalSort.h
+ *
+ *  @brief Sorting of zipped columns that do not fit in memory. Sorted
+ *         runs are spilled to columnar files in a temporary directory
+ *         and then merged with a loser tree, all within a memory budget.
+ */
+
+
+
+#ifndef EXTERNAL_SORT_ZIP_ITER_H
+#define EXTERNAL_SORT_ZIP_ITER_H
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/types.h>
+#endif
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+using FilePtr = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+
+/// Moves to the byte 'offset' of 'file', which may be past 2GB. Returns 0 on success, as 'std::fseek'
+inline int seekFile (std::FILE* file, std::uint64_t offset)
+{
+#if defined(_WIN32)
+    return offset <= std::uint64_t(std::numeric_limits<long long>::max()) ? _fseeki64(file, (long long)(offset), SEEK_SET) : -1;
+#elif defined(__unix__) || defined(__APPLE__)
+    return offset <= std::uint64_t(std::numeric_limits<off_t>::max()) ? fseeko(file, off_t(offset), SEEK_SET) : -1;
+#else
+    return offset <= std::uint64_t(std::numeric_limits<long>::max()) ? std::fseek(file, long(offset), SEEK_SET) : -1;
+#endif
+}
+
+
+/** \class RunFile
+  *
+  * A sorted run on disk: all the rows of the first column, then all the
+  * rows of the second one, and so on. The file is removed on destruction,
+  * so no temporary is left behind even if the sort throws.
+*/
+template <typename... Ts>
+class RunFile
+{
+public:
+
+    RunFile (std::string path) : path(std::move(path)) {}
+
+    ~RunFile () { std::remove(path.c_str()); }
+
+
+    RunFile (const RunFile&) = delete;
+
+    RunFile& operator= (const RunFile&) = delete;
+
+
+
+    /// Writes the first 'n' rows of the buffers, with a single write per column
+    void write (const std::tuple< std::vector< Ts >... >& columns, std::size_t n)
+    {
+        write(columns, n, std::index_sequence_for<Ts...>());
+    }
+
+
+    std::string path;
+
+    std::size_t rows = 0;
+
+
+private:
+
+    template <std::size_t... Is>
+    void write (const std::tuple< std::vector< Ts >... >& columns, std::size_t n, std::index_sequence<Is...>)
+    {
+        FilePtr file(std::fopen(path.c_str(), "wb"), &std::fclose);
+
+        if(!file)
+            throw std::runtime_error("Could not create the run file " + path);
+
+        bool ok = true;
+
+        const auto& dummie = { ( ok = ok && std::fwrite(std::get<Is>(columns).data(), sizeof(Ts), n, file.get()) == n, int{} )... };
+
+        if(!ok || std::fflush(file.get()))
+            throw std::runtime_error("Could not write the run file " + path);
+
+        rows = n;
+    }
+};
+
+
+
+/** \class RunReader
+  *
+  * Reads a run file sequentially through a buffer of a fixed number of
+  * rows for each column. When every buffered row was consumed, the buffers
+  * are refilled with a single large read per column.
+*/
+template <typename... Ts>
+class RunReader
+{
+public:
+
+    RunReader (const RunFile<Ts...>& run, std::size_t capacity) :
+               file(std::fopen(run.path.c_str(), "rb"), &std::fclose), rows(run.rows), capacity(std::max(capacity, std::size_t(1)))
+    {
+        if(!file)
+            throw std::runtime_error("Could not open the run file " + run.path);
+
+        init(std::index_sequence_for<Ts...>());
+    }
+
+
+
+    bool done () const { return pos == rows; }
+
+    const auto& key () const { return std::get<0>(buffers)[pos - first]; }
+
+
+    /// The current row, as a tuple of references into the buffers
+    auto row () const { return row(std::index_sequence_for<Ts...>()); }
+
+
+    void next ()
+    {
+        if(++pos < rows && pos == first + size)
+            refill(std::index_sequence_for<Ts...>());
+    }
+
+
+
+private:
+
+    template <std::size_t... Is>
+    void init (std::index_sequence<Is...>)
+    {
+        std::size_t sizes[] = { sizeof(Ts)... };
+
+        std::uint64_t offset = 0;
+
+        for(std::size_t i = 0; i < sizeof...(Ts); offset += std::uint64_t(rows) * sizes[i++])
+            offsets[i] = offset;
+
+        const auto& dummie = { ( std::get<Is>(buffers).resize(std::min(capacity, rows)), int{} )... };
+
+        if(rows)
+            refill(std::index_sequence_for<Ts...>());
+    }
+
+
+    template <std::size_t... Is>
+    auto row (std::index_sequence<Is...>) const
+    {
+        return std::forward_as_tuple( std::get<Is>(buffers)[pos - first]... );
+    }
+
+
+    template <std::size_t... Is>
+    void refill (std::index_sequence<Is...>)
+    {
+        first = pos;
+        size = std::min(capacity, rows - pos);
+
+        bool ok = true;
+
+        const auto& dummie = { ( ok = ok && !seekFile(file.get(), offsets[Is] + std::uint64_t(pos) * sizeof(Ts)) &&
+                                      std::fread(std::get<Is>(buffers).data(), sizeof(Ts), size, file.get()) == size, int{} )... };
+
+        if(!ok)
+            throw std::runtime_error("Could not read a run file");
+    }
+
+
+
+    FilePtr file;
+
+    std::size_t rows, capacity, pos = 0, first = 0, size = 0;
+
+    std::uint64_t offsets[sizeof...(Ts)];
+
+    std::tuple< std::vector< Ts >... > buffers;
+};
+
+
+
+/** \class LoserTree
+  *
+  * Tournament tree for the k-way merge. Each internal node keeps the loser
+  * of the match played there and the root keeps the overall winner, so
+  * replacing the winner replays a single path of log(k) matches. 'less(a, b)'
+  * tells if the current element of source 'a' goes before the one of source 'b'.
+*/
+template <class Less>
+class LoserTree
+{
+public:
+
+    LoserTree (std::size_t k, Less less) : k(k), less(less), tree(k, k)
+    {
+        for(std::size_t i = k; i > 0; --i)
+            replay(i - 1);
+    }
+
+
+    std::size_t winner () const { return tree[0]; }
+
+
+    /// Must be called whenever the current element of source 's' changes
+    void replay (std::size_t s)
+    {
+        for(std::size_t t = (s + k) / 2; t > 0; t /= 2)
+            if(beats(tree[t], s))
+                std::swap(s, tree[t]);
+
+        tree[0] = s;
+    }
+
+
+private:
+
+    /// 'k' is a virtual source that beats every other one, used only while building the tree
+    bool beats (std::size_t a, std::size_t b) const
+    {
+        return a == k || (b != k && less(a, b));
+    }
+
+
+    std::size_t k;
+
+    Less less;
+
+    std::vector<std::size_t> tree;
+};
+
+
+
+template <class ZipT, class OutIter, class Compare, std::size_t... Is>
+OutIter externalSort (const ZipT& zipped, const std::string& tmpdir, std::size_t memBudget,
+                      OutIter out, Compare compare, std::index_sequence<Is...>)
+{
+    using Key     = ColumnType<ZipT, 0>;
+    using Buffers = std::tuple< std::vector< ColumnType<ZipT, Is> >... >;
+    using Run     = RunFile< ColumnType<ZipT, Is>... >;
+    using Reader  = RunReader< ColumnType<ZipT, Is>... >;
+
+    static_assert(std::is_same< std::integer_sequence< bool, true, std::is_trivially_copyable< ColumnType<ZipT, Is> >::value... >,
+                                std::integer_sequence< bool, std::is_trivially_copyable< ColumnType<ZipT, Is> >::value..., true > >::value,
+                  "Every column must be trivially copyable to be spilled to disk");
+
+    const std::size_t sizes[] = { sizeof(ColumnType<ZipT, Is>)... };
+
+    const std::size_t n = zipped.size(), rowBytes = std::accumulate(std::begin(sizes), std::end(sizes), std::size_t(0));
+
+    /// Each row of a run takes its columns plus a (key, row) pair for the sort
+    const std::size_t runRows = std::max(memBudget / (rowBytes + sizeof(std::pair<Key, std::size_t>)), std::size_t(1));
+
+
+    Buffers buffers;
+
+    const auto& dummie = { ( std::get<Is>(buffers).resize(std::min(n, runRows)), int{} )... };
+
+    std::vector< std::pair<Key, std::size_t> > keys(std::min(n, runRows));
+
+
+    /** The keys are sorted with their row, which breaks the ties so the sort is stable
+      * without the extra buffer of 'std::stable_sort', and the columns are then gathered
+    */
+    auto sortRun = [&](std::size_t b, std::size_t m)
+    {
+        auto keyColumn = help::begin(zipped.template get<0>()) + b;
+
+        for(std::size_t i = 0; i < m; ++i)
+            keys[i] = std::make_pair(keyColumn[i], i);
+
+        std::sort(keys.begin(), keys.begin() + m, [&](const auto& x, const auto& y)
+        {
+            return compare(x.first, y.first) || (!compare(y.first, x.first) && x.second < y.second);
+        });
+
+        const auto& dummie = { ( [&](auto column, auto& buffer)
+        {
+            for(std::size_t i = 0; i < m; ++i)
+                buffer[i] = column[keys[i].second];
+
+        }(help::begin(zipped.template get<Is>()) + b, std::get<Is>(buffers)), int{} )... };
+    };
+
+
+    /// Everything fits in a single run, so there is nothing to spill
+    if(n <= runRows)
+    {
+        sortRun(0, n);
+
+        for(std::size_t i = 0; i < n; ++i, ++out)
+            *out = std::forward_as_tuple(std::get<Is>(buffers)[i]...);
+
+        return out;
+    }
+
+
+    const std::string prefix = tmpdir + "/zipiter-run-" + std::to_string(reinterpret_cast<std::uintptr_t>(&buffers)) + "-" +
+                               std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-";
+
+    std::vector< std::unique_ptr< Run > > runs;
+
+    for(std::size_t b = 0; b < n; b += runRows)
+    {
+        std::size_t m = std::min(runRows, n - b);
+
+        sortRun(b, m);
+
+        runs.emplace_back(new Run(prefix + std::to_string(runs.size())));
+
+        runs.back()->write(buffers, m);
+    }
+
+    buffers = Buffers();
+
+    keys = std::vector< std::pair<Key, std::size_t> >();
+
+
+    /// The budget is now divided among the buffers of all the runs
+    std::vector< Reader > readers;
+
+    readers.reserve(runs.size());
+
+    for(auto& run : runs)
+        readers.emplace_back(*run, memBudget / (runs.size() * rowBytes));
+
+
+    /// Exhausted runs lose every match. Ties go to the earlier run, which keeps the sort stable
+    auto less = [&](std::size_t a, std::size_t b)
+    {
+        if(readers[a].done()) return false;
+        if(readers[b].done()) return true;
+
+        if(compare(readers[a].key(), readers[b].key())) return true;
+        if(compare(readers[b].key(), readers[a].key())) return false;
+
+        return a < b;
+    };
+
+    LoserTree< decltype(less) > tree(readers.size(), less);
+
+    for(std::size_t w = tree.winner(); !readers[w].done(); w = tree.winner(), ++out)
+    {
+        *out = readers[w].row();
+
+        readers[w].next();
+
+        tree.replay(w);
+    }
+
+    return out;
+}
+
+} // namespace help
+
+
+
+
+/** Sorts 'zipped' by its first column using at most about 'memBudget'
+  * bytes for the data, writing the sorted rows to 'out'. The input is read
+  * in runs that fit in the budget, which are sorted in memory through their
+  * keys (so the budget also holds a key and an index per row) and written to
+  * columnar files in 'tmpdir'. The runs are then merged with a loser tree,
+  * reading each one through a buffer with a share of the budget. Every column
+  * must be trivially copyable, since the runs are raw binary files. 'out' is
+  * assigned a tuple with the values of each row, so it can be a 'ZipIter' over
+  * the output columns or an inserter into a container of tuples. The sort is
+  * stable, 'compare' has the same meaning as in 'std::sort' and the run files
+  * are removed before returning, even on errors (thrown as std::runtime_error).
+  * The input containers must be random access.
+*/
+template <class Compare = std::less<>, typename... Containers, class OutIter>
+OutIter externalSort (const Zip<Containers...>& zipped, const std::string& tmpdir, std::size_t memBudget,
+                      OutIter out, Compare compare = Compare())
+{
+    return help::externalSort(zipped, tmpdir, memBudget, out, compare, std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+} // namespace it
+
+
+
+#endif // EXTERNAL_SORT_ZIP_ITER_H
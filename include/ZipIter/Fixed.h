@@ -0,0 +1,146 @@
+/**
+ *  @file    Fixed.h
+ *
+ *  @brief Zipped loops over fixed size arrays ('std::array' and built in
+ *         arrays), unrolled at compile time. Everything is 'constexpr', so
+ *         with a 'constexpr' function it can run in a 'static_assert' or
+ *         build a table at compile time.
+ */
+
+
+
+#ifndef FIXED_ZIP_ITER_H
+#define FIXED_ZIP_ITER_H
+
+#include <array>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/// The number of elements of a fixed size array
+template <class T>                   struct FixedSize;
+template <class T, std::size_t N>    struct FixedSize< std::array<T, N> >       : std::integral_constant<std::size_t, N> {};
+template <class T, std::size_t N>    struct FixedSize< const std::array<T, N> > : std::integral_constant<std::size_t, N> {};
+template <class T, std::size_t N>    struct FixedSize< T[N] >                   : std::integral_constant<std::size_t, N> {};
+
+
+/// The I-th element of a fixed size array, through the accesses that are 'constexpr' in C++14
+template <std::size_t I, class T, std::size_t N>
+constexpr T& fixedGet (std::array<T, N>& a) { return std::get<I>(a); }
+
+template <std::size_t I, class T, std::size_t N>
+constexpr const T& fixedGet (const std::array<T, N>& a) { return std::get<I>(a); }
+
+template <std::size_t I, class T, std::size_t N>
+constexpr T& fixedGet (T (&a)[N]) { return a[I]; }
+
+
+/// Calls 'f' with the I-th element of every array in 'args', the last element of 'args' being 'f' itself
+template <std::size_t I, class F, class Tuple, std::size_t... Js>
+constexpr decltype(auto) fixedCall (F& f, Tuple& args, std::index_sequence<Js...>)
+{
+    return f( fixedGet<I>( std::get<Js>(args) )... );
+}
+
+
+template <class F, class Tuple, std::size_t... Is>
+constexpr void forEachFixed (F& f, Tuple& args, std::index_sequence<Is...>)
+{
+    constexpr auto arrays = std::make_index_sequence< std::tuple_size<Tuple>::value - 1 >();
+
+    const auto& dummie = { int{}, ( fixedCall<Is>(f, args, arrays), int{} )... };
+}
+
+
+template <class F, class Tuple, std::size_t... Is>
+constexpr auto transformFixed (F& f, Tuple& args, std::index_sequence<Is...>)
+{
+    constexpr auto arrays = std::make_index_sequence< std::tuple_size<Tuple>::value - 1 >();
+
+    using R = std::decay_t< decltype( fixedCall<0>(f, args, arrays) ) >;
+
+    return std::array< R, sizeof...(Is) >{{ fixedCall<Is>(f, args, arrays)... }};
+}
+
+
+/// The size shared by all the arrays in 'args' (every element but the last, the function)
+template <class Tuple, class = std::make_index_sequence< std::tuple_size<Tuple>::value - 1 >>
+struct FixedArgs;
+
+template <class Tuple, std::size_t... Js>
+struct FixedArgs< Tuple, std::index_sequence<Js...> >
+{
+    static constexpr std::size_t size = FixedSize< std::remove_reference_t< std::tuple_element_t<0, Tuple> > >::value;
+
+    static_assert(std::is_same< std::integer_sequence< bool, true, ( FixedSize< std::remove_reference_t< std::tuple_element_t<Js, Tuple> > >::value == size )... >,
+                                std::integer_sequence< bool, ( FixedSize< std::remove_reference_t< std::tuple_element_t<Js, Tuple> > >::value == size )..., true > >::value,
+                  "The arrays must all have the same size");
+
+    using Function = std::decay_t< std::tuple_element_t< sizeof...(Js), Tuple > >;
+};
+
+} // namespace help
+
+
+
+
+/** The same as 'forEach', for fixed size arrays of the same size. The
+  * function comes last and receives the I-th elements of all arrays, for
+  * every I, in a sequence of calls unrolled at compile time, without any
+  * loop control. Returns a copy of the function after all the calls:
+  *
+  *     std::array<double, 3> a, b;
+  *
+  *     forEachFixed(a, b, [&](double& x, double y){ x += 2 * y; });
+  *
+  * It is 'constexpr', and can run at compile time if the function can
+  * (a function object with a 'constexpr' call operator, or any lambda in C++17).
+*/
+template <typename... Args>
+constexpr auto forEachFixed (Args&&... args)
+{
+    auto tup = std::forward_as_tuple( std::forward<Args>(args)... );
+
+    using Fixed = help::FixedArgs< decltype(tup) >;
+
+    typename Fixed::Function f = std::get< sizeof...(Args) - 1 >(tup);
+
+    help::forEachFixed(f, tup, std::make_index_sequence< Fixed::size >());
+
+    return f;
+}
+
+
+
+/** Applies the function (the last argument) to the I-th elements of all
+  * arrays for every I, unrolled, and returns the results in a 'std::array'.
+  * With a 'constexpr' function this builds lookup tables at compile time.
+*/
+template <typename... Args>
+constexpr auto transformFixed (Args&&... args)
+{
+    auto tup = std::forward_as_tuple( std::forward<Args>(args)... );
+
+    using Fixed = help::FixedArgs< decltype(tup) >;
+
+    typename Fixed::Function f = std::get< sizeof...(Args) - 1 >(tup);
+
+    return help::transformFixed(f, tup, std::make_index_sequence< Fixed::size >());
+}
+
+
+} // namespace it
+
+
+
+#endif // FIXED_ZIP_ITER_H
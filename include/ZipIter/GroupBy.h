@@ -0,0 +1,306 @@
+/**
+ *  @file    GroupBy.h
+ *
+ *  @brief Hash based aggregation of zipped key/value columns. The rows
+ *         are grouped by the first column without sorting anything.
+ */
+
+
+
+#ifndef GROUP_BY_ZIP_ITER_H
+#define GROUP_BY_ZIP_ITER_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "ZipIter.h"
+#include "HashIndex.h"
+
+
+
+namespace it
+{
+
+/** The aggregators used by 'groupBy'. Each one gets a row (a tuple with
+  * one reference per zipped column, the key being the first) and keeps a
+  * state for each group. 'first' returns the state after the first row of
+  * the group, and 'update' adds any other row to the state. The index 'I'
+  * of the built in aggregators refers to the column of the zipped range.
+*/
+namespace agg
+{
+
+template <std::size_t I>
+struct Sum
+{
+    template <class Row>
+    auto first (const Row& row) const { return std::decay_t< std::tuple_element_t< I, Row > >( std::get<I>(row) ); }
+
+    template <class State, class Row>
+    void update (State& state, const Row& row) const { state += std::get<I>(row); }
+};
+
+
+template <std::size_t I>
+struct Min
+{
+    template <class Row>
+    auto first (const Row& row) const { return std::decay_t< std::tuple_element_t< I, Row > >( std::get<I>(row) ); }
+
+    template <class State, class Row>
+    void update (State& state, const Row& row) const { if(std::get<I>(row) < state) state = std::get<I>(row); }
+};
+
+
+template <std::size_t I>
+struct Max
+{
+    template <class Row>
+    auto first (const Row& row) const { return std::decay_t< std::tuple_element_t< I, Row > >( std::get<I>(row) ); }
+
+    template <class State, class Row>
+    void update (State& state, const Row& row) const { if(state < std::get<I>(row)) state = std::get<I>(row); }
+};
+
+
+struct Count
+{
+    template <class Row>
+    std::size_t first (const Row&) const { return 1; }
+
+    template <class Row>
+    void update (std::size_t& state, const Row&) const { ++state; }
+};
+
+
+/** A custom aggregator. The function receives the state by reference
+  * followed by all the elements of the row unpacked, as in 'unZip'.
+*/
+template <typename T, class F>
+struct Reduce
+{
+    template <class Row>
+    T first (const Row& row) const
+    {
+        T state = init;
+
+        update(state, row);
+
+        return state;
+    }
+
+    template <class Row>
+    void update (T& state, const Row& row) const
+    {
+        unZip(row, [&](auto&&... elems){ function(state, std::forward<decltype(elems)>(elems)...); });
+    }
+
+    T init;
+
+    F function;
+};
+
+
+
+/// The functions that should be called instead of using the classes directly
+template <std::size_t I> Sum<I> sum () { return {}; }
+
+template <std::size_t I> Min<I> min () { return {}; }
+
+template <std::size_t I> Max<I> max () { return {}; }
+
+inline Count count () { return {}; }
+
+template <typename T, class F>
+Reduce<T, F> reduce (T init, F function) { return { init, function }; }
+
+} // namespace agg
+
+
+
+
+namespace help
+{
+
+template <class ZipT>
+using KeyOf = std::decay_t< std::tuple_element_t< 0, typename ZipT::iterator::value_type > >;
+
+template <class ZipT, class Agg>
+using AggState = decltype( std::declval<Agg>().first( rowAt( std::declval<const ZipT&>(), 0,
+                                                             std::make_index_sequence< ZipT::containersSize >() ) ) );
+
+
+
+/** Aggregates a sequence of rows. The groups are the ids given by a
+  * 'HashIndex', and the states of each aggregator are kept as separated
+  * columns indexed by those ids.
+*/
+template <class ZipT, class... Aggs>
+class Grouper
+{
+public:
+
+    using Key = KeyOf<ZipT>;
+
+    using result_type = std::tuple< std::vector< Key >, std::vector< AggState< ZipT, Aggs > >... >;
+
+
+    Grouper (const ZipT& zipped, const std::tuple<Aggs...>& aggs, std::size_t expected) :
+             zipped(zipped), aggs(aggs), index(expected) {}
+
+
+
+    void add (std::size_t row)
+    {
+        add(rowAt(zipped, row, std::make_index_sequence< ZipT::containersSize >()),
+            std::make_index_sequence< sizeof...(Aggs) >());
+    }
+
+
+    /// The keys in order of appearance, followed by one column per aggregator
+    result_type result ()
+    {
+        return std::tuple_cat(std::make_tuple(index.extractKeys()), std::move(states));
+    }
+
+
+
+private:
+
+    template <class Row, std::size_t... Js>
+    void add (const Row& row, std::index_sequence<Js...>)
+    {
+        auto ins = index.insert(std::get<0>(row));
+
+        if(ins.second)
+            const auto& dummie = { int{}, ( std::get<Js>(states).push_back( std::get<Js>(aggs).first(row) ), int{} )... };
+
+        else
+            const auto& dummie = { int{}, ( std::get<Js>(aggs).update( std::get<Js>(states)[ins.first], row ), int{} )... };
+    }
+
+
+
+    const ZipT& zipped;
+
+    std::tuple<Aggs...> aggs;
+
+    HashIndex<Key> index;
+
+    std::tuple< std::vector< AggState< ZipT, Aggs > >... > states;
+};
+
+
+
+/// Appends every column of 'src' to the respective column of 'dst'
+template <class Tuple, std::size_t... Is>
+void appendColumns (Tuple& dst, Tuple&& src, std::index_sequence<Is...>)
+{
+    const auto& dummie = { ( std::get<Is>(dst).insert( std::get<Is>(dst).end(),
+                                                       std::make_move_iterator( std::get<Is>(src).begin() ),
+                                                       std::make_move_iterator( std::get<Is>(src).end() ) ), int{} )... };
+}
+
+} // namespace help
+
+
+
+
+/** Groups the rows of 'zipped' by the key (the first column) and applies
+  * every aggregator to each group. The return is a tuple of std::vector's:
+  * the distinct keys in order of first appearance, followed by the state
+  * of each aggregator for the respective key. For instance:
+  *
+  *     auto res = groupBy(zip(keys, vals), agg::sum<1>(), agg::count());
+  *
+  * The containers must be random access.
+*/
+template <typename... Containers, class... Aggs>
+auto groupBy (const Zip<Containers...>& zipped, Aggs... aggs)
+{
+    help::Grouper<Zip<Containers...>, Aggs...> grouper(zipped, std::make_tuple(aggs...), 0);
+
+    for(std::size_t row = 0, n = zipped.size(); row < n; ++row)
+        grouper.add(row);
+
+    return grouper.result();
+}
+
+
+
+/** Parallel version of 'groupBy'. The rows are first split among the
+  * threads and radix partitioned by the hash of the key, so every key
+  * belongs to a single partition. Then each thread aggregates a partition
+  * alone, with no synchronization and no merging of states. Inside each
+  * partition the rows are visited in their original order, but the groups
+  * are returned one partition after the other.
+*/
+template <typename... Containers, class... Aggs>
+auto groupByParallel (const Zip<Containers...>& zipped, std::size_t numThreads, Aggs... aggs)
+{
+    using ZipT = Zip<Containers...>;
+    using Grouper = help::Grouper<ZipT, Aggs...>;
+
+    numThreads = std::max(numThreads, std::size_t(1));
+
+    std::size_t n = zipped.size();
+
+    HashIndex< help::KeyOf<ZipT> > hasher;
+
+    std::vector< std::vector< std::vector< std::size_t > > > parts(numThreads, std::vector< std::vector< std::size_t > >(numThreads));
+
+    std::vector<std::thread> threads;
+
+
+    /// The high bits of the hash select the partition, while the low ones select the bucket
+    for(std::size_t t = 0; t < numThreads; ++t) threads.emplace_back([&, t]
+    {
+        auto keys = help::begin(zipped.template get<0>());
+
+        for(std::size_t row = t * n / numThreads; row < (t + 1) * n / numThreads; ++row)
+            parts[t][help::partitionOf(hasher.hash(keys[row]), numThreads)].push_back(row);
+    });
+
+    for(auto& thread : threads)
+        thread.join();
+
+    threads.clear();
+
+
+    std::vector<typename Grouper::result_type> results(numThreads);
+
+    for(std::size_t p = 0; p < numThreads; ++p) threads.emplace_back([&, p]
+    {
+        std::size_t size = 0;
+
+        for(std::size_t t = 0; t < numThreads; ++t)
+            size += parts[t][p].size();
+
+        Grouper grouper(zipped, std::make_tuple(aggs...), size / 4);
+
+        for(std::size_t t = 0; t < numThreads; ++t)
+            for(auto row : parts[t][p])
+                grouper.add(row);
+
+        results[p] = grouper.result();
+    });
+
+    for(auto& thread : threads)
+        thread.join();
+
+
+    auto res = std::move(results[0]);
+
+    for(std::size_t p = 1; p < numThreads; ++p)
+        help::appendColumns(res, std::move(results[p]), std::make_index_sequence< sizeof...(Aggs) + 1 >());
+
+    return res;
+}
+
+
+} // namespace it
+
+
+
+#endif // GROUP_BY_ZIP_ITER_H
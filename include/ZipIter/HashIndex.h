@@ -0,0 +1,229 @@
+/**
+ *  @file    HashIndex.h
+ *
+ *  @brief A flat open addressing hash table mapping distinct keys to
+ *         dense ids (in insertion order). It is the building block of
+ *         the hash based algorithms over zipped columns.
+ */
+
+
+
+#ifndef HASH_INDEX_ZIP_ITER_H
+#define HASH_INDEX_ZIP_ITER_H
+
+#include <vector>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
+#include "Helpers.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/** Finalizer of MurmurHash3. Needed because 'std::hash' is usually
+  * the identity for integers, which is terrible for linear probing
+*/
+inline std::size_t mixHash (std::uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return std::size_t(h);
+}
+
+
+/** The partition of 'n' for a hash given by 'HashIndex::hash'. Takes the
+  * high half of the hash, as the low bits select the bucket in the table
+*/
+inline std::size_t partitionOf (std::size_t hash, std::size_t n)
+{
+    return (hash >> (4 * sizeof(std::size_t))) % n;
+}
+
+} // namespace help
+
+
+
+
+/** \class HashIndex
+  *
+  * Each distinct key inserted receives the next id, starting from 0, and
+  * the keys are kept contiguously in that order. The buckets are stored as
+  * two parallel arrays (the id and the full hash of the key), so a probe
+  * only touches the key array when the hashes match. Collisions are
+  * resolved with linear probing, and the load factor is kept under 1/2.
+*/
+template <typename Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class HashIndex
+{
+public:
+
+    /// Returned by 'find' when the key is not present
+    static constexpr std::size_t npos = std::size_t(-1);
+
+
+    HashIndex (std::size_t expected = 0, Hash hasher = Hash(), KeyEqual equal = KeyEqual()) :
+               hasher(hasher), equal(equal)
+    {
+        reserve(expected);
+    }
+
+
+
+    /// Makes room for 'n' keys without rehashing
+    void reserve (std::size_t n)
+    {
+        std::size_t capacity = 16;
+
+        while(capacity < 2 * n)
+            capacity *= 2;
+
+        if(capacity > ids.size())
+            rehash(capacity);
+
+        keyList.reserve(n);
+    }
+
+
+
+    /// The hash used internally. Can be computed once and passed to 'insert' and 'find'
+    std::size_t hash (const Key& key) const
+    {
+        return help::mixHash(hasher(key));
+    }
+
+
+
+    /** Returns the id of the key and whether it was inserted now. The
+      * hash must be the one returned by 'hash' for this key.
+    */
+    std::pair<std::size_t, bool> insert (const Key& key)
+    {
+        return insert(key, hash(key));
+    }
+
+    std::pair<std::size_t, bool> insert (const Key& key, std::size_t h)
+    {
+        if(2 * (keyList.size() + 1) > ids.size())
+            rehash(2 * ids.size());
+
+        std::size_t pos = h & mask;
+
+        for(; ids[pos]; pos = (pos + 1) & mask)
+            if(hashes[pos] == h && equal(keyList[ids[pos] - 1], key))
+                return { ids[pos] - 1, false };
+
+        keyList.push_back(key);
+
+        ids[pos] = keyList.size();
+        hashes[pos] = h;
+
+        return { keyList.size() - 1, true };
+    }
+
+
+
+    /// Returns the id of the key, or 'npos' if it was never inserted
+    std::size_t find (const Key& key) const
+    {
+        return find(key, hash(key));
+    }
+
+    std::size_t find (const Key& key, std::size_t h) const
+    {
+        for(std::size_t pos = h & mask; ids[pos]; pos = (pos + 1) & mask)
+            if(hashes[pos] == h && equal(keyList[ids[pos] - 1], key))
+                return ids[pos] - 1;
+
+        return npos;
+    }
+
+
+
+    /// Brings the first bucket probed for the hash 'h' to the cache
+    void prefetch (std::size_t h) const
+    {
+        help::prefetch(&ids[h & mask]);
+        help::prefetch(&hashes[h & mask]);
+    }
+
+
+
+    /// The number of distinct keys, and the keys themselves in order of id
+    std::size_t size () const { return keyList.size(); }
+
+    const std::vector<Key>& keys () const { return keyList; }
+
+
+    /// Moves the keys out, leaving the index empty
+    std::vector<Key> extractKeys ()
+    {
+        std::vector<Key> res = std::move(keyList);
+
+        keyList.clear();
+
+        rehash(16);
+
+        return res;
+    }
+
+
+
+private:
+
+    void rehash (std::size_t capacity)
+    {
+        ids.assign(capacity, 0);
+        hashes.assign(capacity, 0);
+
+        mask = capacity - 1;
+
+        for(std::size_t id = 0; id < keyList.size(); ++id)
+        {
+            std::size_t h = hash(keyList[id]), pos = h & mask;
+
+            while(ids[pos])
+                pos = (pos + 1) & mask;
+
+            ids[pos] = id + 1;
+            hashes[pos] = h;
+        }
+    }
+
+
+
+    Hash hasher;
+
+    KeyEqual equal;
+
+
+    /// The id + 1 of the key in each bucket (0 for empty) and its hash
+    std::vector<std::size_t> ids;
+
+    std::vector<std::size_t> hashes;
+
+    std::size_t mask = 0;
+
+
+    std::vector<Key> keyList;
+};
+
+
+template <typename Key, class Hash, class KeyEqual>
+constexpr std::size_t HashIndex<Key, Hash, KeyEqual>::npos;
+
+
+} // namespace it
+
+
+
+#endif // HASH_INDEX_ZIP_ITER_H
@@ -0,0 +1,252 @@
+/**
+ *  @file    HashJoin.h
+ *
+ *  @brief Equi-join of two zipped tables on their first column. The
+ *         smaller side is loaded into a flat hash table and the other
+ *         side probes it in small batches, prefetching the buckets.
+ */
+
+
+
+#ifndef HASH_JOIN_ZIP_ITER_H
+#define HASH_JOIN_ZIP_ITER_H
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+#include "ZipIter.h"
+#include "HashIndex.h"
+
+
+
+namespace it
+{
+
+/** The result of a join: each position holds the row of the left
+  * table and the row of the right table of a matching pair.
+*/
+struct JoinRows
+{
+    std::vector<std::size_t> left;
+
+    std::vector<std::size_t> right;
+
+
+    std::size_t size () const { return left.size(); }
+};
+
+
+
+namespace help
+{
+
+/** The hash table of the build side. The distinct keys are given ids by
+  * a 'HashIndex', and the rows with the same key are stored contiguously
+  * (as in a CSR matrix), so all the matches of a probe are read in sequence.
+  * 'rows(i)' gives the i-th row of the build side to be inserted.
+*/
+template <typename Key>
+class JoinTable
+{
+public:
+
+    template <class Keys, class Rows>
+    JoinTable (Keys keys, Rows rows, std::size_t n) : index(n / 2)
+    {
+        std::vector<std::size_t> ids(n);
+
+        for(std::size_t i = 0; i < n; ++i)
+            ids[i] = index.insert(keys[rows(i)]).first;
+
+        offsets.assign(index.size() + 1, 0);
+
+        for(auto id : ids)
+            ++offsets[id + 1];
+
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+
+        buildRows.resize(n);
+
+        for(std::size_t i = 0; i < n; ++i)
+            buildRows[pos[ids[i]]++] = rows(i);
+    }
+
+
+
+    /** Calls 'emit(buildRow, probeRow)' for every match of the 'n' probe
+      * rows. The hashes of a whole batch are computed and their buckets
+      * prefetched before any lookup, so the cache misses overlap.
+    */
+    template <class Keys, class Rows, class Emit>
+    void probe (Keys keys, Rows rows, std::size_t n, Emit emit) const
+    {
+        constexpr std::size_t batchSize = 16;
+
+        std::size_t hashes[batchSize];
+
+        for(std::size_t b = 0; b < n; b += batchSize)
+        {
+            std::size_t m = std::min(batchSize, n - b);
+
+            for(std::size_t j = 0; j < m; ++j)
+            {
+                hashes[j] = index.hash(keys[rows(b + j)]);
+
+                index.prefetch(hashes[j]);
+            }
+
+            for(std::size_t j = 0; j < m; ++j)
+            {
+                std::size_t row = rows(b + j), id = index.find(keys[row], hashes[j]);
+
+                if(id != HashIndex<Key>::npos)
+                    for(std::size_t k = offsets[id]; k < offsets[id + 1]; ++k)
+                        emit(buildRows[k], row);
+            }
+        }
+    }
+
+
+private:
+
+    HashIndex<Key> index;
+
+    std::vector<std::size_t> offsets;
+
+    std::vector<std::size_t> buildRows;
+};
+
+
+
+/** Joins the build and probe keys. With more than one partition both
+  * sides are first radix partitioned by the high bits of the hash, and
+  * each partition is joined separately, so every hash table is small
+  * enough to stay in the cache.
+*/
+template <typename Key, class BuildKeys, class ProbeKeys, class Emit>
+void joinKeys (BuildKeys buildKeys, std::size_t nb, ProbeKeys probeKeys, std::size_t np, std::size_t partitions, Emit emit)
+{
+    auto identity = [](std::size_t i){ return i; };
+
+    if(partitions <= 1)
+        return JoinTable<Key>(buildKeys, identity, nb).probe(probeKeys, identity, np, emit);
+
+
+    HashIndex<Key> hasher;
+
+    auto partition = [&](auto keys, std::size_t n)
+    {
+        std::vector<std::vector<std::size_t>> parts(partitions);
+
+        for(std::size_t i = 0; i < n; ++i)
+            parts[help::partitionOf(hasher.hash(keys[i]), partitions)].push_back(i);
+
+        return parts;
+    };
+
+    auto buildParts = partition(buildKeys, nb);
+    auto probeParts = partition(probeKeys, np);
+
+    for(std::size_t p = 0; p < partitions; ++p)
+    {
+        const auto& build = buildParts[p];
+        const auto& probe = probeParts[p];
+
+        JoinTable<Key>(buildKeys, [&](std::size_t i){ return build[i]; }, build.size())
+                      .probe(probeKeys, [&](std::size_t i){ return probe[i]; }, probe.size(), emit);
+    }
+}
+
+
+/// Number of partitions so the table of each one takes around 1MB
+template <typename Key>
+std::size_t joinPartitions (std::size_t buildSize)
+{
+    std::size_t bytes = buildSize * (sizeof(Key) + 6 * sizeof(std::size_t)), partitions = 1;
+
+    while(bytes / partitions > (std::size_t(1) << 20))
+        partitions *= 2;
+
+    return partitions;
+}
+
+} // namespace help
+
+
+
+
+/** Returns the pairs of rows of 'left' and 'right' having equal keys (the
+  * first column of each). The smaller side is the one loaded into the hash
+  * table. If 'partitions' is 0, it is chosen from the size of the build side:
+  * small tables are joined directly, while the ones that would not fit in the
+  * cache are radix partitioned first. With a single partition the pairs come
+  * in the order of the rows of the other side, and with more the order is
+  * unspecified. The containers must be random access.
+*/
+template <typename... Ls, typename... Rs>
+JoinRows hashJoinRows (const Zip<Ls...>& left, const Zip<Rs...>& right, std::size_t partitions = 0)
+{
+    using Key = std::decay_t< std::tuple_element_t< 0, typename Zip<Ls...>::iterator::value_type > >;
+
+    static_assert(std::is_same< Key, std::decay_t< std::tuple_element_t< 0, typename Zip<Rs...>::iterator::value_type > > >::value,
+                  "Both tables must have the same key type");
+
+
+    JoinRows res;
+
+    auto leftKeys = help::begin(left.template get<0>());
+    auto rightKeys = help::begin(right.template get<0>());
+
+    bool buildLeft = left.size() <= right.size();
+
+    if(!partitions)
+        partitions = help::joinPartitions<Key>(std::min(left.size(), right.size()));
+
+
+    if(buildLeft)
+        help::joinKeys<Key>(leftKeys, left.size(), rightKeys, right.size(), partitions, [&](std::size_t l, std::size_t r)
+        {
+            res.left.push_back(l);
+            res.right.push_back(r);
+        });
+
+    else
+        help::joinKeys<Key>(rightKeys, right.size(), leftKeys, left.size(), partitions, [&](std::size_t r, std::size_t l)
+        {
+            res.left.push_back(l);
+            res.right.push_back(r);
+        });
+
+    return res;
+}
+
+
+
+/** Materializes the join as a tuple of std::vector's: the key, the other
+  * columns of the left table and the other columns of the right table.
+  * The rows found by 'hashJoinRows' can be reused for many gathers.
+*/
+template <typename... Ls, typename... Rs>
+auto hashJoin (const Zip<Ls...>& left, const Zip<Rs...>& right, const JoinRows& rows)
+{
+    return std::tuple_cat( help::gatherRows(left, rows.left, std::make_index_sequence< sizeof...(Ls) >()),
+                           help::gatherRows(right, rows.right, help::IndexRange< 1, sizeof...(Rs) >()) );
+}
+
+template <typename... Ls, typename... Rs>
+auto hashJoin (const Zip<Ls...>& left, const Zip<Rs...>& right, std::size_t partitions = 0)
+{
+    JoinRows rows = hashJoinRows(left, right, partitions);
+
+    return hashJoin(left, right, rows);
+}
+
+
+} // namespace it
+
+
+
+#endif // HASH_JOIN_ZIP_ITER_H
@@ -9,6 +9,9 @@
 #include <type_traits>
 #include <tuple>
 #include <iterator>
+#include <vector>
+
+#include "Stats.h"
 
 
 /// Trick to get the number of arguments passed to a macro
@@ -67,6 +70,8 @@ namespace std
     template <typename... Args>
     void swap (std::tuple<Args...>&& a, std::tuple<Args...>&& b) noexcept
     {
+        ZIP_ITER_STAT(swaps);
+
         swap(a, b);
     }
 }
@@ -177,11 +182,11 @@ using EnableIfMinimumTag = std::enable_if_t< iterTagOrder( Tag{} ) >= iterTagOrd
 
 
 /// Simple functions to be used in the 'execTuple' function. Defined as lambdas for simplicity.
-auto increment = [](auto&& x) { return ++x; };
+const auto increment = [](auto&& x) { return ++x; };
 
-auto decrement = [](auto&& x) { return --x; };
+const auto decrement = [](auto&& x) { return --x; };
 
-auto add       = [](auto&& x, int inc) { return x = x + inc; };
+const auto add       = [](auto&& x, int inc) { return x = x + inc; };
 
 
 
@@ -225,9 +230,9 @@ decltype(auto) end (T t) noexcept
   * with the rest of the arguments, always resulting in a single tuple.
 */
 template <typename... ArgsTup>
-decltype(auto) packArgs (std::tuple< ArgsTup... > tup)
+auto packArgs (std::tuple< ArgsTup... > tup)
 {
-    return std::move( tup );
+    return tup;
 }
 
 template <typename T>
@@ -269,6 +274,50 @@ struct CountElements< std::tuple< TupArgs... >, Args... > : st_constant< sizeof.
 
 
 
+/// The sequence B, B+1, ..., E-1. Useful to expand only part of a tuple
+template <std::size_t B, std::size_t... Is>
+std::index_sequence< (B + Is)... > offsetSequence (std::index_sequence< Is... >);
+
+template <std::size_t B, std::size_t E>
+using IndexRange = decltype( offsetSequence< B >( std::make_index_sequence< E - B >() ) );
+
+
+
+/// Maps a tuple of types to a tuple of std::vector's, one column for each type
+template <typename> struct Columns;
+
+template <typename... Ts> struct Columns < std::tuple< Ts... > > { using type = std::tuple< std::vector< Ts >... >; };
+
+template <typename Tuple> using Columns_t = typename Columns< Tuple >::type;
+
+
+/// The position of the only 'T' in 'Ts...', or 'sizeof...(Ts)' if there is none or more than one
+template <typename T, typename... Ts>
+constexpr std::size_t indexOfType ()
+{
+    constexpr bool same[] = { false, std::is_same< T, Ts >::value... };
+
+    std::size_t index = sizeof...(Ts), count = 0;
+
+    for(std::size_t i = 0; i < sizeof...(Ts); ++i) if(same[i+1])
+        index = i, ++count;
+
+    return count == 1 ? index : sizeof...(Ts);
+}
+
+
+/// Hints the cache about an address that will be read soon
+inline void prefetch (const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void) address;
+#endif
+}
+
+
+
 } // namespace help
 
 } // namespace it
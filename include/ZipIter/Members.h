@@ -0,0 +1,249 @@
+/**
+ *  @file    Members.h
+ *
+ *  @brief Zipping selected fields of a container of structs (AoS), and
+ *         conversions between that layout and separated columns (SoA).
+ */
+
+
+
+#ifndef MEMBERS_ZIP_ITER_H
+#define MEMBERS_ZIP_ITER_H
+
+#include <vector>
+#include <algorithm>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/** \class MemberIter
+  *
+  * Adapts an iterator over structs so dereferencing it gives a reference
+  * to a single field, selected by a pointer to member. It has the same
+  * iterator category as the adapted iterator.
+*/
+template <class Iter, class Class, typename M>
+class MemberIter
+{
+public:
+
+    using iterator_category = typename std::iterator_traits<Iter>::iterator_category;
+    using difference_type   = typename std::iterator_traits<Iter>::difference_type;
+
+    using reference  = decltype( ( *std::declval<Iter>() ).*std::declval<M Class::*>() );
+    using value_type = std::decay_t<reference>;
+    using pointer    = std::remove_reference_t<reference>*;
+
+
+    MemberIter () = default;
+
+    MemberIter (Iter iter, M Class::* member) : iter(iter), member(member) {}
+
+
+
+    reference operator * () const { return (*iter).*member; }
+
+    pointer operator -> () const { return &operator*(); }
+
+    reference operator [] (difference_type pos) const { return iter[pos].*member; }
+
+
+    MemberIter& operator ++ () { ++iter; return *this; }
+    MemberIter& operator -- () { --iter; return *this; }
+
+    MemberIter operator ++ (int) { MemberIter temp{ *this }; ++iter; return temp; }
+    MemberIter operator -- (int) { MemberIter temp{ *this }; --iter; return temp; }
+
+    MemberIter& operator += (difference_type inc) { iter += inc; return *this; }
+    MemberIter& operator -= (difference_type inc) { iter -= inc; return *this; }
+
+
+    friend MemberIter operator + (MemberIter it, difference_type inc) { return it += inc; }
+    friend MemberIter operator + (difference_type inc, MemberIter it) { return it += inc; }
+    friend MemberIter operator - (MemberIter it, difference_type inc) { return it -= inc; }
+
+    friend difference_type operator - (const MemberIter& a, const MemberIter& b) { return a.iter - b.iter; }
+
+
+    friend bool operator == (const MemberIter& a, const MemberIter& b) { return a.iter == b.iter; }
+    friend bool operator != (const MemberIter& a, const MemberIter& b) { return a.iter != b.iter; }
+    friend bool operator <  (const MemberIter& a, const MemberIter& b) { return a.iter <  b.iter; }
+    friend bool operator >  (const MemberIter& a, const MemberIter& b) { return a.iter >  b.iter; }
+    friend bool operator <= (const MemberIter& a, const MemberIter& b) { return a.iter <= b.iter; }
+    friend bool operator >= (const MemberIter& a, const MemberIter& b) { return a.iter >= b.iter; }
+
+
+private:
+
+    Iter iter;
+
+    M Class::* member;
+};
+
+
+
+/** \class MemberView
+  *
+  * A view of a single field of every struct of a container. It can be
+  * passed to 'zip' as any other container. Being a view, constness is
+  * shallow: a const view still gives access to the fields of a non const container.
+*/
+template <class Container, class Class, typename M>
+class MemberView
+{
+public:
+
+    using iterator = MemberIter< typename help::Iterable<Container>::iterator, Class, M >;
+
+    using const_iterator = iterator;
+
+
+    MemberView (Container& container, M Class::* member) : container(&container), member(member) {}
+
+
+    iterator begin () const { return iterator(std::begin(*container), member); }
+
+    iterator end () const { return iterator(std::end(*container), member); }
+
+
+    decltype(auto) operator [] (std::size_t pos) const { return begin()[pos]; }
+
+    std::size_t size () const { return container->size(); }
+
+
+private:
+
+    Container* container;
+
+    M Class::* member;
+};
+
+
+
+
+/** Zips the given fields of the structs in 'container'. The result is a
+  * 'Zip' like any other, so it works in for range loops, with 'ZipIter'
+  * and all the other facilities, without copying the data:
+  *
+  *     for(auto tup : zipMembers(records, &Record::price, &Record::qty)) ...
+*/
+template <class Container, class Class, typename... Ms>
+auto zipMembers (Container& container, Ms Class::*... members)
+{
+    return Zip< MemberView< Container, Class, Ms >... >( MemberView< Container, Class, Ms >(container, members)... );
+}
+
+
+
+
+namespace help
+{
+
+/// Number of structs copied at a time, so a block stays in the L1 cache while every field is visited
+template <class Class>
+constexpr std::size_t blockRows ()
+{
+    return sizeof(Class) >= 16384 ? 1 : 16384 / sizeof(Class);
+}
+
+
+template <class Iter, class Class, typename... Ms, std::size_t... Is>
+auto toSoA (Iter first, std::size_t n, std::index_sequence<Is...>, Ms Class::*... members)
+{
+    std::tuple< std::vector< Ms >... > res;
+
+    const auto& dummie = { ( std::get<Is>(res).resize(n), int{} )... };
+
+    const auto ptrs = std::make_tuple(members...);
+
+    for(std::size_t b = 0; b < n; b += blockRows<Class>())
+    {
+        std::size_t e = std::min(n, b + blockRows<Class>());
+
+        const auto& dummie = { ( [&]
+        {
+            auto& col = std::get<Is>(res);
+            auto member = std::get<Is>(ptrs);
+
+            for(std::size_t i = b; i < e; ++i)
+                col[i] = first[i].*member;
+
+        }(), int{} )... };
+    }
+
+    return res;
+}
+
+
+template <class Iter, class ZipT, class Class, typename... Ms, std::size_t... Is>
+void toAoS (const ZipT& columns, Iter first, std::size_t n, std::index_sequence<Is...>, Ms Class::*... members)
+{
+    const auto ptrs = std::make_tuple(members...);
+
+    for(std::size_t b = 0; b < n; b += blockRows<Class>())
+    {
+        std::size_t e = std::min(n, b + blockRows<Class>());
+
+        const auto& dummie = { ( [&]
+        {
+            auto col = help::begin( columns.template get<Is>() );
+            auto member = std::get<Is>(ptrs);
+
+            for(std::size_t i = b; i < e; ++i)
+                first[i].*member = col[i];
+
+        }(), int{} )... };
+    }
+}
+
+} // namespace help
+
+
+
+
+/** Copies the given fields of the structs in 'records' to a tuple of
+  * std::vector's. The copy is blocked: a block of structs is read once
+  * per field while it is still in the cache, and each column is written sequentially.
+*/
+template <class Container, class Class, typename... Ms>
+auto toSoA (const Container& records, Ms Class::*... members)
+{
+    return help::toSoA(help::begin(records), records.size(), std::index_sequence_for<Ms...>(), members...);
+}
+
+
+
+/** The opposite of 'toSoA'. Writes the zipped 'columns' into the given
+  * fields of the structs in 'records', leaving the other fields untouched.
+  * 'records' must be random access and have at least 'columns.size()' elements.
+*/
+template <class Container, typename... Containers, class Class, typename... Ms>
+void toAoS (const Zip<Containers...>& columns, Container& records, Ms Class::*... members)
+{
+    static_assert(sizeof...(Containers) == sizeof...(Ms), "There must be one field for each column");
+
+    help::toAoS(columns, help::begin(records), columns.size(), std::index_sequence_for<Ms...>(), members...);
+}
+
+
+/// Creates a std::vector of default constructed structs and fill the given fields with 'columns'
+template <typename... Containers, class Class, typename... Ms>
+std::vector<Class> toAoS (const Zip<Containers...>& columns, Ms Class::*... members)
+{
+    std::vector<Class> records(columns.size());
+
+    toAoS(columns, records, members...);
+
+    return records;
+}
+
+
+} // namespace it
+
+
+
+#endif // MEMBERS_ZIP_ITER_H
@@ -0,0 +1,574 @@
+/**
+ *  @file    Nullable.h
+ *
+ *  @brief Columns with missing values, marked in a packed validity bitmap
+ *         (one bit per row, as in Arrow), and null aware reduce, visit and
+ *         compaction that go through the bitmap 64 rows at a time.
+ */
+
+
+
+#ifndef NULLABLE_ZIP_ITER_H
+#define NULLABLE_ZIP_ITER_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include "ZipIter.h"
+#include "ScratchArena.h"
+
+
+
+namespace it
+{
+
+/// Tag to mark a value as missing: 'column.push_back(null)' or 'ref = null'
+struct Null {};
+
+constexpr Null null{};
+
+
+
+template <typename T>
+class NullableValue;
+
+
+
+namespace help
+{
+
+/// The number of 0 bits at the end of 'x', which must not be 0
+inline unsigned trailingZeros (std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return unsigned(__builtin_ctzll(static_cast<unsigned long long>(x)));
+#else
+    unsigned count = 0;
+
+    for(; !(x & 1); x >>= 1)
+        ++count;
+
+    return count;
+#endif
+}
+
+
+/// The number of 1 bits of 'x'
+inline unsigned popCount (std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return unsigned(__builtin_popcountll(static_cast<unsigned long long>(x)));
+#else
+    unsigned count = 0;
+
+    for(; x; x &= x - 1)
+        ++count;
+
+    return count;
+#endif
+}
+
+
+/** Calls 'f(row)' for every bit set in 'words', and 'all(first, last)' for
+  * every word with all the 64 bits set. Words with no bit set cost a single test.
+*/
+template <class F, class All>
+void forEachSetBit (const std::vector<std::uint64_t>& words, F f, All all)
+{
+    for(std::size_t k = 0; k < words.size(); ++k)
+    {
+        std::uint64_t w = words[k];
+
+        if(w == ~std::uint64_t(0))
+            all(64 * k, 64 * k + 64);
+
+        else for(; w; w &= w - 1)
+            f(64 * k + trailingZeros(w));
+    }
+}
+
+} // namespace help
+
+
+
+
+/** \class NullableRef
+  *
+  * A reference to an element of a 'Nullable' column, working as a
+  * 'std::optional<T>&' would: it can be tested, read when it has a value,
+  * and assigned a value or 'null'. Assigning writes to the column, as any
+  * reference. 'T' is const for read only access.
+*/
+template <typename T>
+class NullableRef
+{
+public:
+
+    using value_type = std::remove_const_t<T>;
+
+
+    NullableRef (T* value, std::conditional_t< std::is_const<T>::value, const std::uint64_t, std::uint64_t >* word, std::uint64_t bit) :
+                 ptr(value), word(word), bit(bit) {}
+
+    NullableRef (const NullableRef&) = default;
+
+
+
+    bool has_value () const { return *word & bit; }
+
+    explicit operator bool () const { return has_value(); }
+
+
+    /// The value, which must be present. Throws if it is null
+    T& value () const
+    {
+        if(!has_value())
+            throw std::runtime_error("Access to the value of a null element");
+
+        return *ptr;
+    }
+
+    T& operator * () const { return *ptr; }
+
+    T* operator -> () const { return ptr; }
+
+    value_type value_or (const value_type& other) const { return has_value() ? *ptr : other; }
+
+
+
+    const NullableRef& operator = (const value_type& x) const
+    {
+        *ptr = x;
+        *word |= bit;
+
+        return *this;
+    }
+
+    const NullableRef& operator = (Null) const
+    {
+        *word &= ~bit;
+
+        return *this;
+    }
+
+    /// Copies the element referenced by 'other', null or not
+    const NullableRef& operator = (const NullableRef& other) const
+    {
+        return other.has_value() ? operator=(*other.ptr) : operator=(null);
+    }
+
+    /// Copies a value taken out of the column, null or not
+    const NullableRef& operator = (const NullableValue<value_type>& other) const
+    {
+        return other.has_value() ? operator=(*other) : operator=(null);
+    }
+
+
+    /// Swaps the referenced elements, not the references
+    friend void swap (NullableRef& a, NullableRef& b)
+    {
+        NullableValue<value_type> temp(a);
+
+        a = b;
+        b = temp;
+    }
+
+
+    friend bool operator == (const NullableRef& a, Null) { return !a.has_value(); }
+    friend bool operator != (const NullableRef& a, Null) { return a.has_value(); }
+
+
+private:
+
+    T* ptr;
+
+    std::conditional_t< std::is_const<T>::value, const std::uint64_t, std::uint64_t >* word;
+
+    std::uint64_t bit;
+};
+
+
+
+
+/** \class NullableValue
+  *
+  * An element taken out of a 'Nullable' column, working as a 'std::optional<T>'.
+  * It is the value type of the column iterator, so the copies made by the
+  * sort algorithms own their value instead of pointing into the column.
+*/
+template <typename T>
+class NullableValue
+{
+public:
+
+    using value_type = T;
+
+
+    NullableValue () = default;
+
+    NullableValue (const T& value) : val(value), valid(true) {}
+
+    NullableValue (Null) {}
+
+    template <typename U>
+    NullableValue (const NullableRef<U>& ref) : val(*ref), valid(ref.has_value()) {}
+
+
+
+    bool has_value () const { return valid; }
+
+    explicit operator bool () const { return has_value(); }
+
+
+    /// The value, which must be present. Throws if it is null
+    const T& value () const
+    {
+        if(!has_value())
+            throw std::runtime_error("Access to the value of a null element");
+
+        return val;
+    }
+
+    const T& operator * () const { return val; }
+
+    const T* operator -> () const { return &val; }
+
+    T value_or (const T& other) const { return has_value() ? val : other; }
+
+
+    friend bool operator == (const NullableValue& a, Null) { return !a.has_value(); }
+    friend bool operator != (const NullableValue& a, Null) { return a.has_value(); }
+
+
+private:
+
+    T val = T();
+
+    bool valid = false;
+};
+
+
+
+
+namespace help
+{
+
+/// Random access iterator over a 'Nullable', giving a 'NullableRef' by value
+template <class Column>
+class NullableIter
+{
+public:
+
+    using iterator_category = std::random_access_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = decltype( std::declval<Column&>()[0] );
+    using value_type        = NullableValue< typename reference::value_type >;
+    using pointer           = void;
+
+
+    NullableIter () = default;
+
+    NullableIter (Column* column, std::size_t pos) : col(column), pos(pos) {}
+
+
+
+    reference operator * () const { return (*col)[pos]; }
+
+    reference operator [] (difference_type inc) const { return (*col)[pos + inc]; }
+
+
+    Column& column () const { return *col; }
+
+
+    NullableIter& operator ++ () { ++pos; return *this; }
+    NullableIter& operator -- () { --pos; return *this; }
+
+    NullableIter operator ++ (int) { NullableIter temp{ *this }; ++pos; return temp; }
+    NullableIter operator -- (int) { NullableIter temp{ *this }; --pos; return temp; }
+
+    NullableIter& operator += (difference_type inc) { pos += inc; return *this; }
+    NullableIter& operator -= (difference_type inc) { pos -= inc; return *this; }
+
+
+    friend NullableIter operator + (NullableIter it, difference_type inc) { return it += inc; }
+    friend NullableIter operator + (difference_type inc, NullableIter it) { return it += inc; }
+    friend NullableIter operator - (NullableIter it, difference_type inc) { return it -= inc; }
+
+    friend difference_type operator - (const NullableIter& a, const NullableIter& b) { return difference_type(a.pos) - difference_type(b.pos); }
+
+
+    friend bool operator == (const NullableIter& a, const NullableIter& b) { return a.pos == b.pos; }
+    friend bool operator != (const NullableIter& a, const NullableIter& b) { return a.pos != b.pos; }
+    friend bool operator <  (const NullableIter& a, const NullableIter& b) { return a.pos <  b.pos; }
+    friend bool operator >  (const NullableIter& a, const NullableIter& b) { return a.pos >  b.pos; }
+    friend bool operator <= (const NullableIter& a, const NullableIter& b) { return a.pos <= b.pos; }
+    friend bool operator >= (const NullableIter& a, const NullableIter& b) { return a.pos >= b.pos; }
+
+
+private:
+
+    Column* col = nullptr;
+
+    std::size_t pos = 0;
+};
+
+} // namespace help
+
+
+
+
+/** \class Nullable
+  *
+  * A random access column 'Col' (a std::vector, for instance) plus a
+  * validity bitmap with a bit per row, set when the row has a value. Null
+  * rows keep whatever value is in the column, usually 'T()'. The bits after
+  * the last row are always 0, so the last word needs no special care.
+  *
+  * It can be passed to 'zip', giving a 'NullableRef' per row. The functions
+  * after the class work on the bitmap a word at a time instead.
+*/
+template <class Col>
+class Nullable
+{
+public:
+
+    using T = std::decay_t< decltype( *help::begin( std::declval<Col&>() ) ) >;
+
+    using value_type = NullableRef<T>;
+
+    using iterator = help::NullableIter< Nullable >;
+
+    using const_iterator = help::NullableIter< const Nullable >;
+
+
+
+    Nullable () = default;
+
+    /// Every value of 'values' is valid
+    explicit Nullable (Col values) : vals(std::move(values)), bits((vals.size() + 63) / 64, ~std::uint64_t(0))
+    {
+        if(vals.size() % 64)
+            bits.back() = (std::uint64_t(1) << (vals.size() % 64)) - 1;
+    }
+
+
+
+    void reserve (std::size_t n)
+    {
+        vals.reserve(n);
+        bits.reserve((n + 63) / 64);
+    }
+
+    void push_back (const T& value)
+    {
+        vals.push_back(value);
+
+        if(vals.size() % 64 == 1)
+            bits.push_back(0);
+
+        bits.back() |= std::uint64_t(1) << ((vals.size() - 1) % 64);
+    }
+
+    void push_back (Null)
+    {
+        vals.push_back(T());
+
+        if(vals.size() % 64 == 1)
+            bits.push_back(0);
+    }
+
+
+
+    NullableRef<T> operator [] (std::size_t pos)
+    {
+        return NullableRef<T>(&help::begin(vals)[pos], &bits[pos / 64], std::uint64_t(1) << (pos % 64));
+    }
+
+    NullableRef<const T> operator [] (std::size_t pos) const
+    {
+        return NullableRef<const T>(&help::begin(vals)[pos], &bits[pos / 64], std::uint64_t(1) << (pos % 64));
+    }
+
+
+    iterator begin () { return iterator(this, 0); }
+
+    iterator end () { return iterator(this, size()); }
+
+    const_iterator begin () const { return const_iterator(this, 0); }
+
+    const_iterator end () const { return const_iterator(this, size()); }
+
+
+    std::size_t size () const { return vals.size(); }
+
+    bool empty () const { return vals.empty(); }
+
+
+    bool valid (std::size_t pos) const { return (bits[pos / 64] >> (pos % 64)) & 1; }
+
+    std::size_t nullCount () const
+    {
+        std::size_t valids = 0;
+
+        for(auto w : bits)
+            valids += help::popCount(w);
+
+        return size() - valids;
+    }
+
+
+    /// The values, including the ones of null rows, and the validity bitmap
+    Col& values () { return vals; }
+
+    const Col& values () const { return vals; }
+
+    const std::vector<std::uint64_t>& bitmap () const { return bits; }
+
+    /// The bits after the last row must be kept at 0
+    std::vector<std::uint64_t>& bitmap () { return bits; }
+
+
+
+private:
+
+    Col vals;
+
+    std::vector<std::uint64_t> bits;
+};
+
+
+
+
+/** Calls 'f(row, value)' for each valid row of 'column', in order. Whole
+  * words of nulls are skipped with a single test, and whole words of valid
+  * rows are visited with no test at all.
+*/
+template <class Col, class F>
+void forEachValid (const Nullable<Col>& column, F f)
+{
+    auto values = help::begin(column.values());
+
+    help::forEachSetBit(column.bitmap(), [&](std::size_t row){ f(row, values[row]); },
+                        [&](std::size_t first, std::size_t last)
+                        {
+                            for(std::size_t row = first; row < last; ++row)
+                                f(row, values[row]);
+                        });
+}
+
+
+
+/// Reduction of the valid values of 'column' with 'op', starting at 'init'. The nulls are ignored
+template <class Col, typename U, class Op = std::plus<>>
+U reduce (const Nullable<Col>& column, U init, Op op = Op())
+{
+    forEachValid(column, [&](std::size_t, const auto& value){ init = op(init, value); });
+
+    return init;
+}
+
+
+
+namespace help
+{
+
+/// The algorithms of 'ScratchArena.h' permute the values and the validity bits of a 'Nullable' together
+template <class Col>
+void permuteColumn (NullableIter< Nullable<Col> > column, const std::size_t* perm, std::size_t n, ScratchArena& arena)
+{
+    Nullable<Col>& nullable = column.column();
+
+    permuteColumn(help::begin(nullable.values()), perm, n, arena);
+
+
+    ScratchArena::Scope scope(arena);
+
+    std::vector<std::uint64_t>& bits = nullable.bitmap();
+
+    std::uint64_t* buffer = arena.allocate<std::uint64_t>(bits.size());
+
+    std::copy(bits.begin(), bits.end(), buffer);
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        std::uint64_t bit = std::uint64_t(1) << (i % 64);
+
+        buffer[i / 64] = nullable.valid(perm[i]) ? buffer[i / 64] | bit : buffer[i / 64] & ~bit;
+    }
+
+    std::copy(buffer, buffer + bits.size(), bits.begin());
+}
+
+
+/// Left packs the rows of a column whose bit is set in 'words', from the row 'start' on. Returns the new size
+template <class Iter>
+std::size_t packByBitmap (Iter column, const std::vector<std::uint64_t>& words, std::size_t start)
+{
+    std::size_t j = start;
+
+    for(std::size_t w = start / 64; w < words.size(); ++w)
+    {
+        std::uint64_t bits = w == start / 64 ? words[w] & (~std::uint64_t(0) << (start % 64)) : words[w];
+
+        if(bits == ~std::uint64_t(0))
+            for(std::size_t row = 64 * w; row < 64 * w + 64; ++row)
+                column[j++] = std::move(column[row]);
+
+        else for(; bits; bits &= bits - 1)
+            column[j++] = std::move(column[64 * w + trailingZeros(bits)]);
+    }
+
+    return j;
+}
+
+
+template <class ZipT, std::size_t... Is>
+std::size_t packRowsByBitmap (const ZipT& zipped, const std::vector<std::uint64_t>& words, std::size_t start, std::index_sequence<Is...>)
+{
+    std::size_t size = start;
+
+    const auto& dummie = { ( size = packByBitmap( help::begin( zipped.template get<Is>() ), words, start ), int{} )... };
+
+    return size;
+}
+
+} // namespace help
+
+
+
+/** Keeps the rows of 'zipped' that are valid in 'mask', in order, as
+  * 'compact' does with a predicate. Returns the new number of rows, and
+  * the containers are not resized. The rows before the first null are
+  * not touched, and after it each column is packed following the bitmap.
+  * To drop the nulls of 'mask' itself, zip its 'values()': all the rows
+  * kept are then valid, but the bitmap is left as it was.
+*/
+template <class Col, typename... Containers>
+std::size_t compactNulls (const Nullable<Col>& mask, Zip<Containers...> zipped)
+{
+    const auto& words = mask.bitmap();
+
+    std::size_t k = 0;
+
+    while(k < words.size() && words[k] == ~std::uint64_t(0))
+        ++k;
+
+    if(k == words.size())
+        return mask.size();
+
+    std::size_t start = 64 * k + help::trailingZeros(~words[k]);
+
+    return help::packRowsByBitmap(zipped, words, start, std::index_sequence_for<Containers...>());
+}
+
+
+} // namespace it
+
+
+
+#endif // NULLABLE_ZIP_ITER_H
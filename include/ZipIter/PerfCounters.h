@@ -0,0 +1,224 @@
+/**
+ *  @file    PerfCounters.h
+ *
+ *  @brief Hardware performance counters (cycles, instructions, cache,
+ *         branch and TLB misses) read through Linux 'perf_event_open',
+ *         to explain the cost of zipped kernels. If a counter can not be
+ *         opened (other systems, virtual machines, restrictive
+ *         'perf_event_paranoid') it is simply reported as unavailable.
+ */
+
+
+
+#ifndef PERF_COUNTERS_ZIP_ITER_H
+#define PERF_COUNTERS_ZIP_ITER_H
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
+
+namespace it
+{
+
+namespace perf
+{
+
+/// The measured events
+enum Event
+{
+    cycles, instructions, l1dMisses, llcMisses, branchMisses, dtlbMisses, numEvents
+};
+
+
+inline const char* eventName (int event)
+{
+    static const char* names[] = { "cycles", "instructions", "L1d misses", "LLC misses", "branch misses", "dTLB misses" };
+
+    return names[event];
+}
+
+
+
+/// The result of a measurement. Unavailable counters have a negative value
+struct Sample
+{
+    double seconds = 0.0;
+
+    std::array<double, numEvents> values;
+
+
+    Sample () { values.fill(-1.0); }
+
+    bool available (int event) const { return values[event] >= 0.0; }
+};
+
+
+
+
+/** \class Counters
+  *
+  * Opens one counter for each event of the calling thread, counting only
+  * user space. The counters are independent, so each one that fails to
+  * open is just skipped. When the kernel multiplexes the counters, the
+  * values are scaled by the fraction of time each one was really running.
+*/
+class Counters
+{
+public:
+
+    Counters ()
+    {
+        fds.fill(-1);
+
+#if defined(__linux__)
+
+        const std::uint64_t cache = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        const std::uint32_t types[] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                        PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+
+        const std::uint64_t configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_L1D | cache, PERF_COUNT_HW_CACHE_LL | cache,
+                                          PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_DTLB | cache };
+
+        for(int e = 0; e < numEvents; ++e)
+        {
+            perf_event_attr attr{};
+
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds[e] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+
+    ~Counters ()
+    {
+#if defined(__linux__)
+        for(int fd : fds) if(fd >= 0)
+            close(fd);
+#endif
+    }
+
+
+    Counters (const Counters&) = delete;
+
+    Counters& operator= (const Counters&) = delete;
+
+
+
+    /// Whether the event could be opened at all
+    bool available (int event) const { return fds[event] >= 0; }
+
+
+
+    void start ()
+    {
+#if defined(__linux__)
+        for(int fd : fds) if(fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        begin = std::chrono::steady_clock::now();
+    }
+
+
+    Sample stop ()
+    {
+        Sample sample;
+
+        sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+#if defined(__linux__)
+        for(int e = 0; e < numEvents; ++e) if(fds[e] >= 0)
+        {
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+
+            std::uint64_t data[3];
+
+            if(read(fds[e], data, sizeof(data)) == sizeof(data) && data[2])
+                sample.values[e] = double(data[0]) * double(data[1]) / double(data[2]);
+        }
+#endif
+
+        return sample;
+    }
+
+
+
+private:
+
+    std::array<int, numEvents> fds;
+
+    std::chrono::steady_clock::time_point begin;
+};
+
+
+
+
+/// Measures a single call to 'f'
+template <class F>
+Sample measure (F f)
+{
+    Counters counters;
+
+    counters.start();
+
+    f();
+
+    return counters.stop();
+}
+
+
+
+/** Writes a line with the time and every counter divided by the number
+  * of elements processed, so kernels of different sizes can be compared.
+  * Unavailable counters are printed as "n/a".
+*/
+inline std::ostream& report (std::ostream& out, const std::string& name, const Sample& sample, std::size_t elements)
+{
+    double n = elements ? double(elements) : 1.0;
+
+    out << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(3)
+        << std::setw(10) << 1e9 * sample.seconds / n << " ns";
+
+    for(int e = 0; e < numEvents; ++e)
+    {
+        out << "  " << eventName(e) << ": " << std::setw(8);
+
+        if(sample.available(e)) out << sample.values[e] / n;
+        else                    out << "n/a";
+    }
+
+    return out << "\n";
+}
+
+
+} // namespace perf
+
+} // namespace it
+
+
+
+#endif // PERF_COUNTERS_ZIP_ITER_H
@@ -0,0 +1,294 @@
+/**
+ *  @file    Pipeline.h
+ *
+ *  @brief Runs a sequence of stages over a zipped range, cut in batches,
+ *         with each stage in its own thread. The batches are passed from
+ *         one stage to the next through lock free single producer single
+ *         consumer queues, so all the stages work at the same time.
+ */
+
+
+
+#ifndef PIPELINE_ZIP_ITER_H
+#define PIPELINE_ZIP_ITER_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <iterator>
+#include <thread>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/** \class SpscQueue
+  *
+  * Bounded ring buffer for exactly one producer thread and one consumer
+  * thread. The head and tail are kept in different cache lines, so the
+  * two threads do not fight over the same line. 'push' and 'pop' spin
+  * (yielding the thread) while the queue is full or empty, which gives
+  * backpressure: a fast producer waits for a slow consumer.
+*/
+template <typename T>
+class SpscQueue
+{
+public:
+
+    SpscQueue (std::size_t capacity) : buffer(capacity + 1) {}
+
+
+
+    bool tryPush (const T& value)
+    {
+        std::size_t t = tail.load(std::memory_order_relaxed), next = (t + 1) % buffer.size();
+
+        if(next == head.load(std::memory_order_acquire))
+            return false;
+
+        buffer[t] = value;
+
+        tail.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+
+    bool tryPop (T& value)
+    {
+        std::size_t h = head.load(std::memory_order_relaxed);
+
+        if(h == tail.load(std::memory_order_acquire))
+            return false;
+
+        value = buffer[h];
+
+        head.store((h + 1) % buffer.size(), std::memory_order_release);
+
+        return true;
+    }
+
+
+
+    /** Blocking versions. They give up and return false only if 'stop'
+      * becomes true while waiting.
+    */
+    bool push (const T& value, const std::atomic<bool>& stop)
+    {
+        while(!tryPush(value))
+        {
+            if(stop.load(std::memory_order_relaxed))
+                return false;
+
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+    bool pop (T& value, const std::atomic<bool>& stop)
+    {
+        while(!tryPop(value))
+        {
+            if(stop.load(std::memory_order_relaxed))
+                return false;
+
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+
+
+private:
+
+    std::vector<T> buffer;
+
+    char pad0[64];
+
+    std::atomic<std::size_t> head{ 0 };
+
+    char pad1[64];
+
+    std::atomic<std::size_t> tail{ 0 };
+
+    char pad2[64];
+};
+
+
+
+
+/** Turns a function taking the elements of a single row (as in 'unZip')
+  * into a stage for 'pipeline', which is called with a whole batch.
+*/
+template <class F>
+auto perRow (F f)
+{
+    return [f](auto first, auto last)
+    {
+        std::for_each(first, last, unZip(f));
+    };
+}
+
+
+
+
+namespace help
+{
+
+/// A batch is a range of rows. The empty batch marks the end of the input
+struct Batch
+{
+    std::size_t first, last;
+};
+
+
+/// An iterator to the row 'pos' of 'zipped', advancing each column with the full size of 'pos'
+template <class ZipT, std::size_t... Is>
+auto iterAt (ZipT& zipped, std::size_t pos, std::index_sequence<Is...>)
+{
+    return typename ZipT::iterator( std::next( help::begin( zipped.template get<Is>() ), std::ptrdiff_t(pos) )... );
+}
+
+
+/** The loop of each stage thread. The first stage creates the batches,
+  * and the others read them from the queue of the previous stage.
+*/
+template <class ZipT, class Stage>
+void runStage (ZipT& zipped, Stage& stage, std::size_t n, std::size_t batchSize,
+               SpscQueue<Batch>* in, SpscQueue<Batch>* out, std::atomic<bool>& stop)
+{
+    Batch batch{ 0, 0 };
+
+    for(std::size_t b = 0; !stop.load(std::memory_order_relaxed); b += batchSize)
+    {
+        if(in)
+        {
+            if(!in->pop(batch, stop))
+                return;
+        }
+
+        else
+            batch = Batch{ std::min(b, n), std::min(b + batchSize, n) };
+
+
+        if(batch.first == batch.last)
+        {
+            if(out)
+                out->push(batch, stop);
+
+            return;
+        }
+
+        constexpr auto seq = std::make_index_sequence< ZipT::containersSize >();
+
+        stage(iterAt(zipped, batch.first, seq), iterAt(zipped, batch.last, seq));
+
+        if(out && !out->push(batch, stop))
+            return;
+    }
+}
+
+} // namespace help
+
+
+
+
+/// The size of the batches, and how many batches each queue between two stages holds
+struct PipelineOptions
+{
+    std::size_t batchSize = 4096;
+
+    std::size_t depth = 4;
+};
+
+
+
+/** Runs all the 'stages' over 'zipped', cut in batches of rows. Each
+  * stage is called with the 'begin' and 'end' iterators of a batch (see
+  * 'perRow' to write it for a single row). Every stage runs in its own
+  * thread and sees the batches in order. The stages run at the same time
+  * over different batches, so they must not touch rows outside of the batch
+  * they receive. If a stage throws, the pipeline stops and the exception
+  * is rethrown here. The containers must be random access.
+*/
+template <typename... Containers, class... Stages>
+void pipeline (Zip<Containers...> zipped, PipelineOptions options, Stages... stages)
+{
+    constexpr std::size_t numStages = sizeof...(Stages);
+
+    static_assert(numStages > 0, "There must be at least one stage");
+
+
+    std::size_t n = zipped.size(), batchSize = std::max(options.batchSize, std::size_t(1));
+
+    std::vector<std::unique_ptr<SpscQueue<help::Batch>>> queues;
+
+    for(std::size_t i = 0; i + 1 < numStages; ++i)
+        queues.emplace_back(new SpscQueue<help::Batch>(std::max(options.depth, std::size_t(1))));
+
+
+    std::atomic<bool> stop{ false };
+
+    std::vector<std::exception_ptr> errors(numStages);
+
+    std::vector<std::thread> threads;
+
+
+    auto start = [&](auto& stage)
+    {
+        std::size_t s = threads.size();
+
+        threads.emplace_back([&, s]
+        {
+            try
+            {
+                help::runStage(zipped, stage, n, batchSize, s ? queues[s-1].get() : nullptr,
+                               s + 1 < numStages ? queues[s].get() : nullptr, stop);
+            }
+
+            catch(...)
+            {
+                errors[s] = std::current_exception();
+
+                stop = true;
+            }
+        });
+    };
+
+    const auto& dummie = { ( start(stages), int{} )... };
+
+
+    for(auto& thread : threads)
+        thread.join();
+
+    for(auto& error : errors)
+        if(error)
+            std::rethrow_exception(error);
+}
+
+
+/// Uses the default depth of the queues
+template <typename... Containers, class... Stages>
+void pipeline (Zip<Containers...> zipped, std::size_t batchSize, Stages... stages)
+{
+    PipelineOptions options;
+
+    options.batchSize = batchSize;
+
+    pipeline(zipped, options, stages...);
+}
+
+
+} // namespace it
+
+
+
+#endif // PIPELINE_ZIP_ITER_H
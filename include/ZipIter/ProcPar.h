@@ -0,0 +1,414 @@
+/**
+ *  @file    ProcPar.h
+ *
+ *  @brief Parallel loops over zipped columns with processes instead of
+ *         threads, for code that is not thread safe. The columns are put
+ *         in shared memory, each forked worker processes its own range of
+ *         rows, and small results come back through shared memory too.
+ */
+
+
+
+#ifndef PROC_PAR_ZIP_ITER_H
+#define PROC_PAR_ZIP_ITER_H
+
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <cerrno>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+#endif
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/** \class SharedMemory
+  *
+  * Memory shared with the processes forked after its creation, through an
+  * anonymous shared mapping. Where that is not available (and the workers
+  * run in the calling process) it is ordinary memory.
+*/
+class SharedMemory
+{
+public:
+
+    SharedMemory (std::size_t bytes) : length(std::max(bytes, std::size_t(1)))
+    {
+#if defined(__unix__) || defined(__APPLE__)
+
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if(memory == MAP_FAILED)
+            throw std::runtime_error("Could not map shared memory");
+
+#else
+
+        memory = ::operator new(length);
+
+#endif
+    }
+
+    ~SharedMemory ()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(memory, length);
+#else
+        ::operator delete(memory);
+#endif
+    }
+
+
+    SharedMemory (SharedMemory&& other) noexcept : memory(other.memory), length(other.length) { other.memory = nullptr, other.length = 0; }
+
+    SharedMemory (const SharedMemory&) = delete;
+
+    SharedMemory& operator= (const SharedMemory&) = delete;
+
+
+
+    void* data () const { return memory; }
+
+    std::size_t size () const { return length; }
+
+
+private:
+
+    void* memory;
+
+    std::size_t length;
+};
+
+} // namespace help
+
+
+
+
+/** \class SharedColumn
+  *
+  * A fixed size column living in shared memory, so the processes forked
+  * by 'procPar' read and write it in place. It can be zipped as any other
+  * random access container. Columns of other types are copied to shared
+  * memory and back around every 'procPar' call instead.
+*/
+template <typename T>
+class SharedColumn
+{
+public:
+
+    static_assert(std::is_trivially_copyable<T>::value, "The elements of a shared column must be trivially copyable");
+
+
+    using value_type = T;
+
+    using iterator = T*;
+
+    using const_iterator = const T*;
+
+
+    explicit SharedColumn (std::size_t n, const T& value = T()) : memory(n * sizeof(T)), n(n)
+    {
+        std::fill(begin(), end(), value);
+    }
+
+    template <class Iter, class = std::enable_if_t< !std::is_integral<Iter>::value >>
+    SharedColumn (Iter first, Iter last) : memory(std::distance(first, last) * sizeof(T)), n(std::distance(first, last))
+    {
+        std::copy(first, last, begin());
+    }
+
+
+
+    T* data () { return static_cast<T*>(memory.data()); }
+
+    const T* data () const { return static_cast<const T*>(memory.data()); }
+
+
+    T* begin () { return data(); }
+
+    T* end () { return data() + n; }
+
+    const T* begin () const { return data(); }
+
+    const T* end () const { return data() + n; }
+
+
+    T& operator [] (std::size_t pos) { return data()[pos]; }
+
+    const T& operator [] (std::size_t pos) const { return data()[pos]; }
+
+
+    std::size_t size () const { return n; }
+
+
+private:
+
+    help::SharedMemory memory;
+
+    std::size_t n;
+};
+
+
+
+
+namespace help
+{
+
+template <class T> struct IsSharedColumn                     : std::false_type {};
+template <class T> struct IsSharedColumn< SharedColumn<T> >  : std::true_type  {};
+
+
+/** \class SharedRows
+  *
+  * Pointers to the rows of every column of a 'Zip' in shared memory. The
+  * 'SharedColumn's are used directly, and the other columns are copied to
+  * a shared buffer, which 'writeBack' copies back into the containers.
+*/
+template <class ZipT, class = std::make_index_sequence< ZipT::containersSize >>
+class SharedRows;
+
+template <class ZipT, std::size_t... Is>
+class SharedRows< ZipT, std::index_sequence<Is...> >
+{
+public:
+
+    SharedRows (const ZipT& zipped) : zipped(zipped), n(zipped.size())
+    {
+        const auto& dummie = { ( share< Is >(), int{} )... };
+    }
+
+
+    /// Calls 'f' with the elements of the rows [first, last)
+    template <class F>
+    void forEach (std::size_t first, std::size_t last, F& f) const
+    {
+        for(std::size_t i = first; i < last; ++i)
+            f( std::get<Is>(columns)[i]... );
+    }
+
+    template <typename T, class F>
+    T reduce (std::size_t first, std::size_t last, T acc, F& f) const
+    {
+        for(std::size_t i = first; i < last; ++i)
+            acc = f( acc, std::get<Is>(columns)[i]... );
+
+        return acc;
+    }
+
+
+    void writeBack () const
+    {
+        const auto& dummie = { ( writeBack< Is >(), int{} )... };
+    }
+
+
+private:
+
+    template <std::size_t I>
+    using Column = std::decay_t< decltype( std::declval<const ZipT&>().template get<I>() ) >;
+
+
+    template <std::size_t I>
+    void share ()
+    {
+        using T = ColumnType<ZipT, I>;
+
+        static_assert(IsSharedColumn< Column<I> >::value || std::is_trivially_copyable<T>::value,
+                      "The columns must be trivially copyable to be shared with other processes");
+
+        auto first = help::begin( zipped.template get<I>() );
+
+        if(IsSharedColumn< Column<I> >::value)
+            std::get<I>(columns) = const_cast<T*>(&*first);
+
+        else
+        {
+            buffers.emplace_back(n * sizeof(T));
+
+            std::get<I>(columns) = static_cast<T*>(buffers.back().data());
+
+            std::copy(first, first + n, std::get<I>(columns));
+        }
+    }
+
+    template <std::size_t I>
+    void writeBack () const
+    {
+        if(!IsSharedColumn< Column<I> >::value)
+            std::copy(std::get<I>(columns), std::get<I>(columns) + n, help::begin( zipped.template get<I>() ));
+    }
+
+
+
+    const ZipT& zipped;
+
+    std::size_t n;
+
+    std::tuple< ColumnType<ZipT, Is>*... > columns;
+
+    std::vector<SharedMemory> buffers;
+};
+
+
+
+/** Runs 'work(w, first, last)' in 'numProcs' forked processes, the worker
+  * 'w' getting the w-th of 'numProcs' contiguous ranges of the 'n' rows.
+  * Waits for all of them, and throws if any failed. A single worker, or
+  * a system without 'fork', runs the work in the calling process.
+*/
+template <class Work>
+void runWorkers (std::size_t n, std::size_t numProcs, Work work)
+{
+    numProcs = std::max(std::size_t(1), std::min(numProcs, n));
+
+    auto first = [&](std::size_t w){ return w * n / numProcs; };
+
+#if defined(__unix__) || defined(__APPLE__)
+
+    if(numProcs > 1)
+    {
+        std::vector<pid_t> workers;
+
+        bool failed = false;
+
+        for(std::size_t w = 0; w < numProcs && !failed; ++w)
+        {
+            pid_t pid = fork();
+
+            if(pid == 0)
+            {
+                int status = 0;
+
+                try
+                {
+                    work(w, first(w), first(w + 1));
+                }
+
+                catch(...)
+                {
+                    status = 1;
+                }
+
+                _exit(status);
+            }
+
+            if(pid < 0)
+                failed = true;
+
+            else
+                workers.push_back(pid);
+        }
+
+        for(pid_t pid : workers)
+        {
+            int status = 0, res;
+
+            while((res = waitpid(pid, &status, 0)) < 0 && errno == EINTR);
+
+            /// A failed wait (as when SIGCHLD is ignored) tells nothing about the worker, so it counts as a failure
+            failed = failed || res < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        }
+
+        if(failed)
+            throw std::runtime_error("A worker process could not be created or failed");
+
+        return;
+    }
+
+#endif
+
+    for(std::size_t w = 0; w < numProcs; ++w)
+        work(w, first(w), first(w + 1));
+}
+
+} // namespace help
+
+
+
+
+/// Loops run by forked processes over columns in shared memory
+namespace procPar
+{
+
+/** Calls 'f' with the elements of every row of 'zipped' (unpacked, as in
+  * 'forEach'), with the rows split in 'numProcs' contiguous ranges, each
+  * processed by its own forked process. The elements passed to 'f' are
+  * references to shared memory, so the changes it makes are seen by the
+  * caller when this returns. Anything else 'f' changes stays in the worker.
+  *
+  * The containers must be random access, with trivially copyable elements
+  * (or be 'SharedColumn's). If a worker throws or dies, this throws once
+  * all have ended. As with any 'fork', the other threads of the calling
+  * process do not exist in the workers.
+*/
+template <typename... Containers, class F>
+void forEach (Zip<Containers...> zipped, F f, std::size_t numProcs)
+{
+    help::SharedRows< Zip<Containers...> > rows(zipped);
+
+    help::runWorkers(zipped.size(), numProcs, [&](std::size_t, std::size_t first, std::size_t last)
+    {
+        rows.forEach(first, last, f);
+    });
+
+    rows.writeBack();
+}
+
+
+
+/** Each worker folds its range of rows with 'acc = f(acc, elems...)',
+  * starting from 'init', and writes its result to shared memory. The
+  * results are then combined in order of the ranges with 'combine',
+  * so 'init' must be an identity of 'combine' (as 0 for a sum). The result
+  * type must be trivially copyable. The columns are read only.
+*/
+template <typename... Containers, typename T, class F, class Combine = std::plus<>>
+T reduce (Zip<Containers...> zipped, T init, F f, std::size_t numProcs, Combine combine = Combine())
+{
+    static_assert(std::is_trivially_copyable<T>::value, "The result must be trivially copyable to be returned by a worker process");
+
+    help::SharedRows< Zip<Containers...> > rows(zipped);
+
+    numProcs = std::max(std::size_t(1), std::min(numProcs, zipped.size()));
+
+    help::SharedMemory memory(numProcs * sizeof(T));
+
+    T* results = static_cast<T*>(memory.data());
+
+    std::fill(results, results + numProcs, init);
+
+    help::runWorkers(zipped.size(), numProcs, [&](std::size_t w, std::size_t first, std::size_t last)
+    {
+        results[w] = rows.reduce(first, last, init, f);
+    });
+
+    T res = results[0];
+
+    for(std::size_t w = 1; w < numProcs; ++w)
+        res = combine(res, results[w]);
+
+    return res;
+}
+
+} // namespace procPar
+
+
+} // namespace it
+
+
+
+#endif // PROC_PAR_ZIP_ITER_H
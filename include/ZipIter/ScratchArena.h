@@ -0,0 +1,443 @@
+/**
+ *  @file    ScratchArena.h
+ *
+ *  @brief Reusable scratch memory for zipped algorithms, and versions of
+ *         sort, merge, partition and argsort that take all their temporary
+ *         buffers from it. Once the arena has grown to the size needed,
+ *         calling them again makes no heap allocation at all.
+ */
+
+
+
+#ifndef SCRATCH_ARENA_ZIP_ITER_H
+#define SCRATCH_ARENA_ZIP_ITER_H
+
+#include <new>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/** \class ScratchArena
+  *
+  * A stack of memory blocks handing out cache line aligned pieces by bumping
+  * a pointer. Memory is given back in the reverse order it was taken, through
+  * 'Scope' (or 'mark' and 'release'), and the blocks are kept for the next
+  * calls. When everything is released and the arena has more than one block,
+  * they are replaced by a single block of the total size, so the steady state
+  * has a single block big enough for the largest call. 'local()' gives an arena
+  * for the calling thread, to be passed to the algorithms below. The arena itself
+  * is not thread safe.
+*/
+class ScratchArena
+{
+public:
+
+    static constexpr std::size_t alignment = 64;
+
+
+    /// Number of heap allocations made, bytes held, and bytes in use now and at most
+    struct Counters
+    {
+        std::size_t allocations = 0;
+
+        std::size_t reserved = 0;
+
+        std::size_t used = 0;
+
+        std::size_t peak = 0;
+    };
+
+
+    /// A position in the arena. Releasing it frees everything allocated after it
+    struct Marker
+    {
+        std::size_t block, offset, used;
+    };
+
+
+    /// Releases everything allocated during its lifetime
+    class Scope
+    {
+    public:
+
+        Scope (ScratchArena& arena) : arena(arena), marker(arena.mark()) {}
+
+        ~Scope () { arena.release(marker); }
+
+
+        Scope (const Scope&) = delete;
+
+        Scope& operator= (const Scope&) = delete;
+
+
+    private:
+
+        ScratchArena& arena;
+
+        Marker marker;
+    };
+
+
+
+
+    ScratchArena (std::size_t initialBytes = 0)
+    {
+        if(initialBytes)
+            addBlock(initialBytes);
+    }
+
+    ~ScratchArena ()
+    {
+        for(auto& b : blocks)
+            ::operator delete(b.memory);
+    }
+
+
+    ScratchArena (const ScratchArena&) = delete;
+
+    ScratchArena& operator= (const ScratchArena&) = delete;
+
+
+
+    /// The arena of the calling thread
+    static ScratchArena& local ()
+    {
+        static thread_local ScratchArena arena;
+
+        return arena;
+    }
+
+
+
+    /// Uninitialized memory for at least 'bytes' bytes, aligned to a cache line
+    void* allocate (std::size_t bytes)
+    {
+        bytes = (bytes + alignment - 1) / alignment * alignment;
+
+        while(true)
+        {
+            if(block < blocks.size() && offset + bytes <= blocks[block].size)
+            {
+                void* p = blocks[block].data + offset;
+
+                offset += bytes;
+
+                stats.used += bytes;
+                stats.peak = std::max(stats.peak, stats.used);
+
+                return p;
+            }
+
+            if(block + 1 < blocks.size())
+                ++block, offset = 0;
+
+            else
+            {
+                addBlock(std::max(bytes, std::max(stats.reserved, std::size_t(1) << 16)));
+
+                block = blocks.size() - 1, offset = 0;
+            }
+        }
+    }
+
+
+    /// Uninitialized memory for 'n' objects of type T
+    template <typename T>
+    T* allocate (std::size_t n)
+    {
+        static_assert(alignof(T) <= alignment, "The type is over aligned");
+
+        return static_cast<T*>(allocate(n * sizeof(T)));
+    }
+
+
+
+    Marker mark () const { return Marker{ block, offset, stats.used }; }
+
+    void release (const Marker& marker)
+    {
+        block = marker.block, offset = marker.offset, stats.used = marker.used;
+
+        if(!stats.used && blocks.size() > 1)
+            coalesce();
+    }
+
+
+    const Counters& counters () const { return stats; }
+
+
+
+private:
+
+    struct Block
+    {
+        void* memory;
+
+        char* data;
+
+        std::size_t size;
+    };
+
+
+    void addBlock (std::size_t bytes)
+    {
+        void* memory = ::operator new(bytes + alignment);
+
+        char* data = static_cast<char*>(memory) + (alignment - reinterpret_cast<std::uintptr_t>(memory) % alignment) % alignment;
+
+        blocks.push_back(Block{ memory, data, bytes });
+
+        stats.allocations++;
+        stats.reserved += bytes;
+    }
+
+
+    void coalesce ()
+    {
+        std::size_t total = stats.reserved;
+
+        for(auto& b : blocks)
+            ::operator delete(b.memory);
+
+        blocks.clear();
+
+        stats.reserved = 0;
+
+        addBlock(total);
+
+        block = offset = 0;
+    }
+
+
+
+    std::vector<Block> blocks;
+
+    std::size_t block = 0, offset = 0;
+
+    Counters stats;
+};
+
+
+
+
+/// A range of objects living in a 'ScratchArena', valid until the memory is released
+template <typename T>
+struct ScratchSpan
+{
+    T* first;
+
+    std::size_t n;
+
+
+    T* begin () const { return first; }
+
+    T* end () const { return first + n; }
+
+    std::size_t size () const { return n; }
+
+    T& operator [] (std::size_t pos) const { return first[pos]; }
+};
+
+
+
+
+namespace help
+{
+
+/** Stable sort of the indices of 'keys', without any other allocation:
+  * insertion sort of small runs and then passes of 'std::merge' going
+  * back and forth between two buffers of the arena.
+*/
+template <class Iter, class Compare>
+std::size_t* argsortKeys (Iter keys, std::size_t n, ScratchArena& arena, Compare compare)
+{
+    std::size_t* a = arena.allocate<std::size_t>(n), *b = arena.allocate<std::size_t>(n);
+
+    std::iota(a, a + n, std::size_t(0));
+
+    auto less = [&](std::size_t i, std::size_t j){ return compare(keys[i], keys[j]); };
+
+    const std::size_t run = 32;
+
+    for(std::size_t first = 0; first < n; first += run)
+    {
+        for(std::size_t i = first + 1; i < std::min(first + run, n); ++i)
+        {
+            std::size_t x = a[i], j = i;
+
+            for(; j > first && less(x, a[j-1]); --j)
+                a[j] = a[j-1];
+
+            a[j] = x;
+        }
+    }
+
+    for(std::size_t width = run; width < n; width *= 2, std::swap(a, b))
+        for(std::size_t first = 0; first < n; first += 2 * width)
+        {
+            std::size_t mid = std::min(first + width, n), last = std::min(first + 2 * width, n);
+
+            std::merge(a + first, a + mid, a + mid, a + last, b + first, less);
+        }
+
+    return a;
+}
+
+
+/// Moves the row 'perm[i]' of a column to the row 'i', through a buffer in the arena
+template <class Iter>
+void permuteColumn (Iter column, const std::size_t* perm, std::size_t n, ScratchArena& arena)
+{
+    using T = typename std::iterator_traits<Iter>::value_type;
+
+    static_assert(std::is_nothrow_move_constructible<T>::value, "The columns must be nothrow move constructible");
+
+    ScratchArena::Scope scope(arena);
+
+    T* buffer = arena.allocate<T>(n);
+
+    for(std::size_t i = 0; i < n; ++i)
+        ::new (static_cast<void*>(buffer + i)) T(std::move(column[perm[i]]));
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        column[i] = std::move(buffer[i]);
+
+        buffer[i].~T();
+    }
+}
+
+
+template <class ZipT, std::size_t... Is>
+void permuteRows (const ZipT& zipped, const std::size_t* perm, ScratchArena& arena, std::index_sequence<Is...>)
+{
+    const auto& dummie = { ( permuteColumn(help::begin(zipped.template get<Is>()), perm, zipped.size(), arena), int{} )... };
+}
+
+} // namespace help
+
+
+
+
+/** The stable order of the rows of 'zipped' by its first column, as in
+  * 'std::stable_sort'. The indices live in 'arena', so they are valid until
+  * the memory taken from it after this call is released.
+*/
+template <class Compare = std::less<>, typename... Containers>
+ScratchSpan<std::size_t> argsort (const Zip<Containers...>& zipped, ScratchArena& arena, Compare compare = Compare())
+{
+    return { help::argsortKeys(help::begin(zipped.template get<0>()), zipped.size(), arena, compare), zipped.size() };
+}
+
+
+
+/** Stable sort of 'zipped' by its first column. The order is found on the
+  * keys alone and then each column is permuted through a buffer of the arena,
+  * so the only memory used is the arena's. The containers must be random access.
+*/
+template <class Compare = std::less<>, typename... Containers>
+void sort (Zip<Containers...> zipped, ScratchArena& arena, Compare compare = Compare())
+{
+    ScratchArena::Scope scope(arena);
+
+    help::permuteRows(zipped, argsort(zipped, arena, compare).begin(), arena, std::index_sequence_for<Containers...>());
+}
+
+
+
+/** The stable order of the rows of 'zipped' by the columns 'Ks', compared
+  * as tuples (lexicographically, with the default 'compare'). Only those
+  * columns are read, through 'select':
+  *
+  *     auto order = argsortBy<2, 0>(zip(a, b, c), arena);
+*/
+template <std::size_t... Ks, class Compare = std::less<>, typename... Containers>
+ScratchSpan<std::size_t> argsortBy (const Zip<Containers...>& zipped, ScratchArena& arena, Compare compare = Compare())
+{
+    return { help::argsortKeys(zipped.template select<Ks...>(), zipped.size(), arena, compare), zipped.size() };
+}
+
+
+
+/** Stable sort of 'zipped' by the columns 'Ks'. The order is found on the
+  * projected keys alone, and the whole rows are moved once, at the end.
+*/
+template <std::size_t... Ks, class Compare = std::less<>, typename... Containers>
+void sortBy (Zip<Containers...> zipped, ScratchArena& arena, Compare compare = Compare())
+{
+    ScratchArena::Scope scope(arena);
+
+    help::permuteRows(zipped, argsortBy<Ks...>(zipped, arena, compare).begin(), arena, std::index_sequence_for<Containers...>());
+}
+
+
+
+/** The same as 'std::inplace_merge' of the rows [0, mid) and [mid, size())
+  * of 'zipped', both sorted by the first column, using only the arena.
+*/
+template <class Compare = std::less<>, typename... Containers>
+void merge (Zip<Containers...> zipped, std::size_t mid, ScratchArena& arena, Compare compare = Compare())
+{
+    ScratchArena::Scope scope(arena);
+
+    std::size_t n = zipped.size();
+
+    std::size_t* rows = arena.allocate<std::size_t>(n), *perm = arena.allocate<std::size_t>(n);
+
+    std::iota(rows, rows + n, std::size_t(0));
+
+    auto keys = help::begin(zipped.template get<0>());
+
+    std::merge(rows, rows + mid, rows + mid, rows + n, perm, [&](std::size_t i, std::size_t j){ return compare(keys[i], keys[j]); });
+
+    help::permuteRows(zipped, perm, arena, std::index_sequence_for<Containers...>());
+}
+
+
+
+/** The same as 'std::stable_partition' with 'pred' taking the elements of
+  * a row (as in 'unZip'), using only the arena. Returns the number of rows
+  * for which 'pred' is true, which are now the first ones.
+*/
+template <typename... Containers, class Pred>
+std::size_t partition (Zip<Containers...> zipped, Pred pred, ScratchArena& arena)
+{
+    ScratchArena::Scope scope(arena);
+
+    std::size_t n = zipped.size(), front = 0, back = n;
+
+    std::size_t* perm = arena.allocate<std::size_t>(n);
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        if(unZip(help::rowAt(zipped, i, std::index_sequence_for<Containers...>()), pred))
+            perm[front++] = i;
+
+        else
+            perm[--back] = i;
+    }
+
+    std::reverse(perm + front, perm + n);
+
+    help::permuteRows(zipped, perm, arena, std::index_sequence_for<Containers...>());
+
+    return front;
+}
+
+
+
+} // namespace it
+
+
+
+#endif // SCRATCH_ARENA_ZIP_ITER_H
@@ -0,0 +1,232 @@
+/**
+ *  @file    SearchIndex.h
+ *
+ *  @brief Static index for 'lower_bound' searches over a sorted key column.
+ *         The keys are copied in Eytzinger (breadth first) order, so the
+ *         first levels of every search share a few cache lines and the
+ *         descendants of a node can be prefetched a few levels ahead.
+ */
+
+
+
+#ifndef SEARCH_INDEX_ZIP_ITER_H
+#define SEARCH_INDEX_ZIP_ITER_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/// The number of consecutive 1 bits at the end of 'x', which must not be all ones
+inline unsigned trailingOnes (std::size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return unsigned(__builtin_ctzll(~static_cast<unsigned long long>(x)));
+#else
+    unsigned count = 0;
+
+    for(; x & 1; x >>= 1)
+        ++count;
+
+    return count;
+#endif
+}
+
+} // namespace help
+
+
+
+
+/** \class SearchIndex
+  *
+  * Built once over a column sorted by 'operator<'. The searches descend the
+  * implicit tree without branches: at node k they go to '2k + (key < x)', for
+  * a fixed number of levels, prefetching the cache line that holds the
+  * descendants some levels below. The position of the result in the original
+  * column is kept for each node, so the searches return row indices that can
+  * be used with 'Zip::operator[]' or any column. The batched version runs many
+  * searches level by level, so their cache misses overlap.
+*/
+template <typename T>
+class SearchIndex
+{
+public:
+
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+
+    SearchIndex () = default;
+
+    template <class Container>
+    SearchIndex (const Container& sortedKeys) : n(sortedKeys.size()), keys(n + 1), rows(n + 1, n)
+    {
+        build(help::begin(sortedKeys), 0, 1);
+
+        while((std::size_t(2) << levels) - 1 <= n)
+            ++levels;
+    }
+
+
+
+    /// The first row whose key is not less than 'x', or 'size()' if there is none
+    std::size_t lowerBound (const T& x) const
+    {
+        return row(descend(x, [](const T& key, const T& x){ return key < x; }));
+    }
+
+    /// The first row whose key is greater than 'x', or 'size()' if there is none
+    std::size_t upperBound (const T& x) const
+    {
+        return row(descend(x, [](const T& key, const T& x){ return !(x < key); }));
+    }
+
+    /// The first row whose key is equal to 'x', or 'npos'
+    std::size_t find (const T& x) const
+    {
+        std::size_t k = leaf(descend(x, [](const T& key, const T& x){ return key < x; }));
+
+        return k && !(x < keys[k]) ? rows[k] : npos;
+    }
+
+
+
+    /** Writes 'lowerBound' of each value in [first, last) to 'out'. The values
+      * are searched in groups, one level of the tree at a time for the whole
+      * group, which keeps many independent loads in flight.
+    */
+    template <class InIter, class OutIter>
+    OutIter lowerBound (InIter first, InIter last, OutIter out) const
+    {
+        constexpr std::size_t group = 16;
+
+        const T* xs[group];
+        std::size_t ks[group];
+
+        while(first != last)
+        {
+            std::size_t g = 0;
+
+            for(; g < group && first != last; ++g, ++first)
+                xs[g] = &*first, ks[g] = 1;
+
+            for(unsigned level = 0; level < levels; ++level)
+                for(std::size_t i = 0; i < g; ++i)
+                {
+                    help::prefetch(keys.data() + std::min(ks[i] * lineNodes, n));
+
+                    ks[i] = 2 * ks[i] + (keys[ks[i]] < *xs[i]);
+                }
+
+            for(std::size_t i = 0; i < g; ++i, ++out)
+            {
+                if(ks[i] <= n)
+                    ks[i] = 2 * ks[i] + (keys[ks[i]] < *xs[i]);
+
+                *out = row(ks[i]);
+            }
+        }
+
+        return out;
+    }
+
+
+
+    std::size_t size () const { return n; }
+
+
+
+private:
+
+    /// Nodes in a cache line, so prefetching the children 'log2(lineNodes)' levels below costs a single line
+    static constexpr std::size_t lineNodes = sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+
+
+    /// Fills the tree with an in order traversal, which visits the nodes in the order of the sorted keys
+    template <class Iter>
+    std::size_t build (Iter sortedKeys, std::size_t i, std::size_t k)
+    {
+        if(k <= n)
+        {
+            i = build(sortedKeys, i, 2 * k);
+
+            keys[k] = sortedKeys[i];
+            rows[k] = i++;
+
+            i = build(sortedKeys, i, 2 * k + 1);
+        }
+
+        return i;
+    }
+
+
+    /// All the full levels without checking the bounds, then the last, incomplete one
+    template <class Less>
+    std::size_t descend (const T& x, Less less) const
+    {
+        std::size_t k = 1;
+
+        for(unsigned level = 0; level < levels; ++level)
+        {
+            help::prefetch(keys.data() + std::min(k * lineNodes, n));
+
+            k = 2 * k + less(keys[k], x);
+        }
+
+        if(k <= n)
+            k = 2 * k + less(keys[k], x);
+
+        return k;
+    }
+
+
+    /// The node where the search went right for the last time: the answer, or 0 if there is none
+    static std::size_t leaf (std::size_t k)
+    {
+        return k >> (help::trailingOnes(k) + 1);
+    }
+
+    std::size_t row (std::size_t k) const
+    {
+        return rows[leaf(k)];
+    }
+
+
+
+    std::size_t n = 0;
+
+    unsigned levels = 0;
+
+    std::vector<T> keys;
+
+    /// 'rows[0]' is 'n', the answer when every key is smaller
+    std::vector<std::size_t> rows = std::vector<std::size_t>(1, 0);
+};
+
+
+template <typename T>
+constexpr std::size_t SearchIndex<T>::npos;
+
+
+
+/// Builds a 'SearchIndex' over the I-th column of 'zipped', which must be sorted by it
+template <std::size_t I = 0, typename... Containers>
+auto makeSearchIndex (const Zip<Containers...>& zipped)
+{
+    return SearchIndex< help::ColumnType< Zip<Containers...>, I > >(zipped.template get<I>());
+}
+
+
+} // namespace it
+
+
+
+#endif // SEARCH_INDEX_ZIP_ITER_H
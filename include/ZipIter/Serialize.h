@@ -0,0 +1,627 @@
+/**
+ *  @file    Serialize.h
+ *
+ *  @brief Binary columnar format for zipped ranges. The rows are cut in
+ *         blocks and each column of a block is stored with the smallest of
+ *         a few lightweight encodings (raw, run length, frame of reference
+ *         bit packing and delta), so the blocks can be decoded in parallel.
+ */
+
+
+
+#ifndef SERIALIZE_ZIP_ITER_H
+#define SERIALIZE_ZIP_ITER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+using Bytes = std::vector<char>;
+
+
+/// The encodings of a column in a block
+enum class Encoding : std::uint8_t
+{
+    raw, runLength, frameOfReference, delta
+};
+
+
+/// Integers other than bool can be packed. Every other type is stored raw
+template <typename T>
+using IsPackable = std::integral_constant< bool, std::is_integral<T>::value && !std::is_same<T, bool>::value >;
+
+
+/// Only trivially copyable types can be written and read back as bytes
+template <typename... Ts>
+using IsSerializable = std::is_same< std::integer_sequence< bool, true, std::is_trivially_copyable<Ts>::value... >,
+                                     std::integer_sequence< bool, std::is_trivially_copyable<Ts>::value..., true > >;
+
+
+/// Stored in the header for each column, so a file is read back only with the same types
+template <typename T>
+constexpr std::uint8_t typeKind ()
+{
+    return IsPackable<T>::value ? (std::is_signed<T>::value ? 2 : 1) : 0;
+}
+
+
+
+template <typename T>
+void put (Bytes& out, const T& value)
+{
+    const char* p = reinterpret_cast<const char*>(&value);
+
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+T take (const char*& p)
+{
+    T value;
+
+    std::memcpy(&value, p, sizeof(T));
+
+    p += sizeof(T);
+
+    return value;
+}
+
+
+
+/// Maps an integer to an unsigned one keeping the order, so the minimum can be subtracted without overflow
+template <typename T>
+std::uint64_t toOrdered (T value)
+{
+    std::uint64_t u = std::make_unsigned_t<T>(value);
+
+    return std::is_signed<T>::value ? u ^ (std::uint64_t(1) << (8 * sizeof(T) - 1)) : u;
+}
+
+template <typename T>
+T fromOrdered (std::uint64_t u)
+{
+    if(std::is_signed<T>::value)
+        u ^= std::uint64_t(1) << (8 * sizeof(T) - 1);
+
+    return T(std::make_unsigned_t<T>(u));
+}
+
+
+constexpr std::uint64_t signBit = std::uint64_t(1) << 63;
+
+
+inline unsigned bitWidth (std::uint64_t x)
+{
+    unsigned width = 0;
+
+    for(; x; x >>= 1)
+        ++width;
+
+    return width;
+}
+
+inline std::size_t packedWords (std::size_t n, unsigned width)
+{
+    return (n * width + 63) / 64;
+}
+
+
+
+/** Frame of reference: the minimum as base, then each value minus the
+  * base in 'width' bits, packed in 64 bit words.
+*/
+inline void packFor (const std::uint64_t* values, std::size_t n, std::uint64_t base, unsigned width, Bytes& out)
+{
+    put(out, base);
+    put(out, std::uint8_t(width));
+
+    std::vector<std::uint64_t> words(packedWords(n, width));
+
+    if(width) for(std::size_t i = 0; i < n; ++i)
+    {
+        std::uint64_t x = values[i] - base;
+        std::size_t bit = i * width, w = bit / 64, off = bit % 64;
+
+        words[w] |= x << off;
+
+        if(off + width > 64)
+            words[w+1] |= x >> (64 - off);
+    }
+
+    out.insert(out.end(), reinterpret_cast<const char*>(words.data()), reinterpret_cast<const char*>(words.data() + words.size()));
+}
+
+
+inline void unpackFor (const char* p, std::size_t n, std::uint64_t* values)
+{
+    std::uint64_t base = take<std::uint64_t>(p);
+    unsigned width = take<std::uint8_t>(p);
+
+    std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+
+    auto word = [p](std::size_t w){ std::uint64_t x; std::memcpy(&x, p + 8 * w, 8); return x; };
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        if(!width)
+        {
+            values[i] = base;
+            continue;
+        }
+
+        std::size_t bit = i * width, w = bit / 64, off = bit % 64;
+
+        std::uint64_t x = word(w) >> off;
+
+        if(off + width > 64)
+            x |= word(w+1) << (64 - off);
+
+        values[i] = base + (x & mask);
+    }
+}
+
+
+/// Size of a packed block, given where it starts. Returns 0 if the width is invalid
+inline std::size_t packedSize (const char* p, std::size_t n)
+{
+    unsigned width = std::uint8_t(p[8]);
+
+    return width > 64 ? 0 : 9 + 8 * packedWords(n, width);
+}
+
+
+inline void minMax (const std::vector<std::uint64_t>& v, std::size_t first, std::uint64_t& lo, std::uint64_t& hi)
+{
+    lo = hi = first < v.size() ? v[first] : 0;
+
+    for(std::size_t i = first; i < v.size(); ++i)
+        lo = std::min(lo, v[i]), hi = std::max(hi, v[i]);
+}
+
+
+
+
+/// Encodes 'n' values of a column, picking the smallest encoding. Raw is kept on ties, being the fastest to decode
+template <typename T, class Iter>
+void encodeBlock (Iter first, std::size_t n, Bytes& out, std::true_type)
+{
+    std::vector<std::uint64_t> u(n), d(n);
+
+    std::size_t runs = 0;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        u[i] = toOrdered<T>(first[i]);
+
+        runs += i == 0 || u[i] != u[i-1];
+
+        /// The wrapped difference, mapped as a signed integer
+        d[i] = i ? (u[i] - u[i-1]) ^ signBit : 0;
+    }
+
+
+    std::uint64_t lo, hi, dlo, dhi;
+
+    minMax(u, 0, lo, hi);
+    minMax(d, 1, dlo, dhi);
+
+    unsigned width = bitWidth(hi - lo), dwidth = bitWidth(dhi - dlo);
+
+    std::size_t sizes[] = { n * sizeof(T), 4 + runs * (sizeof(T) + 4),
+                            9 + 8 * packedWords(n, width), 17 + 8 * packedWords(n - 1, dwidth) };
+
+    auto encoding = Encoding(std::min_element(std::begin(sizes), std::end(sizes)) - std::begin(sizes));
+
+    put(out, encoding);
+
+
+    if(encoding == Encoding::raw)
+        for(std::size_t i = 0; i < n; ++i)
+            put(out, T(first[i]));
+
+    else if(encoding == Encoding::runLength)
+    {
+        std::vector<std::uint32_t> lengths;
+
+        put(out, std::uint32_t(runs));
+
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            if(i == 0 || u[i] != u[i-1])
+            {
+                put(out, T(first[i]));
+                lengths.push_back(0);
+            }
+
+            ++lengths.back();
+        }
+
+        for(auto length : lengths)
+            put(out, length);
+    }
+
+    else if(encoding == Encoding::frameOfReference)
+        packFor(u.data(), n, lo, width, out);
+
+    else
+    {
+        put(out, u[0]);
+
+        packFor(d.data() + 1, n - 1, dlo, dwidth, out);
+    }
+}
+
+
+template <typename T, class Iter>
+void encodeBlock (Iter first, std::size_t n, Bytes& out, std::false_type)
+{
+    put(out, Encoding::raw);
+
+    for(std::size_t i = 0; i < n; ++i)
+        put(out, T(first[i]));
+}
+
+
+
+[[noreturn]] inline void corrupted ()
+{
+    throw std::runtime_error("Corrupted columnar data");
+}
+
+
+/// Decodes the 'size' bytes of a column of a block, checking every size before reading
+template <typename T, class Iter>
+void decodeBlock (const char* p, std::size_t size, std::size_t n, Iter out, std::false_type)
+{
+    if(size != 1 + n * sizeof(T) || Encoding(*p++) != Encoding::raw)
+        corrupted();
+
+    for(std::size_t i = 0; i < n; ++i)
+        out[i] = take<T>(p);
+}
+
+
+template <typename T, class Iter>
+void decodeBlock (const char* p, std::size_t size, std::size_t n, Iter out, std::true_type)
+{
+    if(size < 1)
+        corrupted();
+
+    auto encoding = take<Encoding>(p);
+
+    --size;
+
+
+    if(encoding == Encoding::raw || encoding > Encoding::delta)
+        return decodeBlock<T>(p - 1, size + 1, n, out, std::false_type());
+
+
+    if(encoding == Encoding::runLength)
+    {
+        if(size < 4)
+            corrupted();
+
+        std::size_t runs = take<std::uint32_t>(p), filled = 0;
+
+        if(size != 4 + runs * (sizeof(T) + 4))
+            corrupted();
+
+        const char* lengths = p + runs * sizeof(T);
+
+        for(std::size_t r = 0; r < runs; ++r)
+        {
+            T value = take<T>(p);
+            std::size_t length = take<std::uint32_t>(lengths);
+
+            if(filled + length > n)
+                corrupted();
+
+            std::fill_n(out + filled, length, value);
+
+            filled += length;
+        }
+
+        if(filled != n)
+            corrupted();
+
+        return;
+    }
+
+
+    std::vector<std::uint64_t> u(n);
+
+    if(encoding == Encoding::frameOfReference)
+    {
+        if(size < 9 || packedSize(p, n) != size)
+            corrupted();
+
+        unpackFor(p, n, u.data());
+    }
+
+    else
+    {
+        if(size < 17 || packedSize(p + 8, n - 1) != size - 8)
+            corrupted();
+
+        u[0] = take<std::uint64_t>(p);
+
+        unpackFor(p, n - 1, u.data() + 1);
+
+        for(std::size_t i = 1; i < n; ++i)
+            u[i] = u[i-1] + (u[i] ^ signBit);
+    }
+
+    for(std::size_t i = 0; i < n; ++i)
+        out[i] = fromOrdered<T>(u[i]);
+}
+
+
+
+
+/// The fixed part of the header. It is followed by the kind and size of each column and the block directory
+struct SerialHeader
+{
+    char magic[4] = { 'Z', 'I', 'P', 'C' };
+
+    std::uint32_t version = 1;
+
+    std::uint64_t rows = 0;
+
+    std::uint64_t blockRows = 0;
+
+    std::uint64_t columns = 0;
+
+
+    std::size_t blocks () const { return blockRows ? (rows + blockRows - 1) / blockRows : 0; }
+};
+
+
+
+template <class ZipT, std::size_t... Is>
+void write (std::ostream& out, const ZipT& zipped, std::size_t blockRows, std::index_sequence<Is...>)
+{
+    static_assert(IsSerializable< ColumnType<ZipT, Is>... >::value, "Every column must be trivially copyable to be serialized");
+
+    SerialHeader header;
+
+    header.columns = sizeof...(Is);
+    header.rows = zipped.size();
+    header.blockRows = std::max(blockRows, std::size_t(1));
+
+
+    Bytes head, data;
+
+    put(head, header);
+
+    const auto& dummie = { ( put(head, typeKind< ColumnType<ZipT, Is> >()),
+                             put(head, std::uint32_t(sizeof(ColumnType<ZipT, Is>))), int{} )... };
+
+
+    for(std::size_t b = 0; b < header.blocks(); ++b)
+    {
+        std::size_t first = b * header.blockRows, n = std::min(std::size_t(header.blockRows), header.rows - first);
+
+        const auto& dummie = { ( [&]
+        {
+            std::size_t start = data.size();
+
+            encodeBlock< ColumnType<ZipT, Is> >(help::begin(zipped.template get<Is>()) + first, n, data,
+                                                IsPackable< ColumnType<ZipT, Is> >());
+
+            put(head, std::uint64_t(data.size() - start));
+
+        }(), int{} )... };
+    }
+
+
+    if(!out.write(head.data(), head.size()) || !out.write(data.data(), data.size()))
+        throw std::runtime_error("Could not write the columnar data");
+}
+
+
+
+/// Reads and checks the header, the types of the columns and the directory of block sizes
+template <typename... Ts>
+SerialHeader readHeader (std::istream& in, std::vector<std::uint64_t>& sizes)
+{
+    static_assert(IsSerializable<Ts...>::value, "Every column must be trivially copyable to be serialized");
+
+    SerialHeader header, expected;
+
+    if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        throw std::runtime_error("Could not read the columnar header");
+
+    if(std::memcmp(header.magic, expected.magic, 4) || header.version != expected.version)
+        throw std::runtime_error("Not a columnar file, or an unknown version");
+
+    if(header.columns != sizeof...(Ts) || (header.rows && !header.blockRows))
+        throw std::runtime_error("The number of columns does not match");
+
+
+    const std::uint8_t kinds[] = { typeKind<Ts>()... };
+    const std::uint32_t typeSizes[] = { std::uint32_t(sizeof(Ts))... };
+
+    for(std::size_t c = 0; c < sizeof...(Ts); ++c)
+    {
+        std::uint8_t kind;
+        std::uint32_t size;
+
+        in.read(reinterpret_cast<char*>(&kind), sizeof(kind));
+        in.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+        if(!in || kind != kinds[c] || size != typeSizes[c])
+            throw std::runtime_error("The types of the columns do not match");
+    }
+
+
+    sizes.resize(header.blocks() * sizeof...(Ts));
+
+    if(!in.read(reinterpret_cast<char*>(sizes.data()), sizes.size() * sizeof(std::uint64_t)))
+        throw std::runtime_error("Could not read the columnar directory");
+
+    return header;
+}
+
+
+
+/** Reads all the data after the header with a single read, then decodes
+  * contiguous ranges of blocks in 'numThreads' threads. Each block is
+  * independent, so they only write to their own rows of the output columns.
+*/
+template <class ZipT, std::size_t... Is>
+void readData (std::istream& in, const SerialHeader& header, const std::vector<std::uint64_t>& sizes,
+               const ZipT& columns, std::size_t numThreads, std::index_sequence<Is...>)
+{
+    std::vector<std::size_t> offsets(sizes.size() + 1, 0);
+
+    for(std::size_t i = 0; i < sizes.size(); ++i)
+        offsets[i+1] = offsets[i] + sizes[i];
+
+    Bytes data(offsets.back());
+
+    if(!in.read(data.data(), data.size()))
+        throw std::runtime_error("Could not read the columnar data");
+
+
+    const std::size_t blocks = header.blocks();
+
+    numThreads = std::max(std::size_t(1), std::min(numThreads, blocks));
+
+    std::vector<std::exception_ptr> errors(numThreads);
+
+    auto decode = [&](std::size_t t)
+    {
+        try
+        {
+            for(std::size_t b = t * blocks / numThreads; b < (t + 1) * blocks / numThreads; ++b)
+            {
+                std::size_t first = b * header.blockRows, n = std::min(std::size_t(header.blockRows), header.rows - first);
+
+                const auto& dummie = { ( decodeBlock< ColumnType<ZipT, Is> >(data.data() + offsets[b * sizeof...(Is) + Is],
+                                                                             sizes[b * sizeof...(Is) + Is], n,
+                                                                             help::begin(columns.template get<Is>()) + first,
+                                                                             IsPackable< ColumnType<ZipT, Is> >()), int{} )... };
+            }
+        }
+
+        catch(...)
+        {
+            errors[t] = std::current_exception();
+        }
+    };
+
+
+    std::vector<std::thread> threads;
+
+    for(std::size_t t = 1; t < numThreads; ++t)
+        threads.emplace_back(decode, t);
+
+    decode(0);
+
+    for(auto& thread : threads)
+        thread.join();
+
+    for(auto& error : errors)
+        if(error)
+            std::rethrow_exception(error);
+}
+
+
+template <class ZipT, std::size_t... Is>
+std::size_t read (std::istream& in, const ZipT& columns, std::size_t numThreads, std::index_sequence<Is...> is)
+{
+    std::vector<std::uint64_t> sizes;
+
+    SerialHeader header = readHeader< ColumnType<ZipT, Is>... >(in, sizes);
+
+    if(columns.size() < header.rows)
+        throw std::runtime_error("The columns are too small for the data");
+
+    readData(in, header, sizes, columns, numThreads, is);
+
+    return header.rows;
+}
+
+
+template <typename... Ts, std::size_t... Is>
+std::tuple< std::vector< Ts >... > read (std::istream& in, std::size_t numThreads, std::index_sequence<Is...> is)
+{
+    std::vector<std::uint64_t> sizes;
+
+    SerialHeader header = readHeader<Ts...>(in, sizes);
+
+    std::tuple< std::vector< Ts >... > res;
+
+    const auto& dummie = { ( std::get<Is>(res).resize(header.rows), int{} )... };
+
+    readData(in, header, sizes, zip(std::get<Is>(res)...), numThreads, is);
+
+    return res;
+}
+
+} // namespace help
+
+
+
+
+/** Writes 'zipped' to a binary stream in a self describing columnar format.
+  * The rows are cut in blocks of 'blockRows' and each column of each block is
+  * encoded on its own, with the smallest of: raw values, run length, frame of
+  * reference (the minimum and then bit packed differences to it) or delta (the
+  * first value and then the bit packed differences between neighbours, good for
+  * sorted columns). Only integers are encoded, other trivially copyable types
+  * are stored raw. Values are written in the byte order of the machine. The
+  * columns must be trivially copyable: strings and other types owning memory
+  * are rejected at compile time.
+*/
+template <typename... Containers>
+void write (std::ostream& out, const Zip<Containers...>& zipped, std::size_t blockRows = 65536)
+{
+    help::write(out, zipped, blockRows, std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+
+/** Reads data written by 'write' into existing random access columns, for
+  * instance memory mapped ones, which must hold at least all the rows. The
+  * blocks are decoded in parallel by 'numThreads' threads. Returns the number
+  * of rows read. Throws std::runtime_error if the types of the columns do not
+  * match the ones written or if the data is corrupted.
+*/
+template <typename... Containers>
+std::size_t read (std::istream& in, Zip<Containers...> columns, std::size_t numThreads = 1)
+{
+    return help::read(in, columns, numThreads, std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+/// Reads data written by 'write' into a tuple of new std::vector's of the given types
+template <typename... Ts>
+std::tuple< std::vector< Ts >... > read (std::istream& in, std::size_t numThreads = 1)
+{
+    return help::read<Ts...>(in, numThreads, std::index_sequence_for<Ts...>());
+}
+
+
+} // namespace it
+
+
+
+#endif // SERIALIZE_ZIP_ITER_H
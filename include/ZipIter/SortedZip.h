@@ -0,0 +1,307 @@
+/**
+ *  @file    SortedZip.h
+ *
+ *  @brief A zipped table kept sorted by its key column under appends.
+ *         New rows go to a small delta that is sorted and merged into
+ *         the main table in linear time, instead of resorting everything.
+ */
+
+
+
+#ifndef SORTED_ZIP_ITER_H
+#define SORTED_ZIP_ITER_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/** \class SortedZip
+  *
+  * Owns a key column and the payload columns, with the rows of the main
+  * table always sorted by the key. Appended rows are kept in a delta until
+  * 'merge' is called (or the delta grows past 'maxDelta'). Appending only
+  * pushes the rows, and the positions of the delta rows are sorted by key
+  * when they are needed: the rows added since the last time are sorted
+  * and merged with the ones already in order. The merge then walks those
+  * positions and merges the delta into the main table in O(n + d log d),
+  * from the back and in place, so nothing but the grown columns is allocated.
+  * The merge is stable: rows with equal keys stay in the order they were
+  * added. Lookups are binary searches on the main table and on the sorted
+  * positions of the delta. They sort the new rows of the delta first, so
+  * they are not const.
+*/
+template <class Compare, typename Key, typename... Ts>
+class SortedZip
+{
+public:
+
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+
+    SortedZip (Compare compare = Compare(), std::size_t maxDelta = npos) : compare(compare), maxDelta(maxDelta) {}
+
+
+
+    /// Appends a single row to the delta
+    void insert (const Key& key, const Ts&... values)
+    {
+        std::get<0>(delta).push_back(key);
+
+        insert(std::index_sequence_for<Ts...>(), values...);
+
+        checkDelta();
+    }
+
+
+
+    /// Appends a batch of rows, given as a zipped range of (key, values...)
+    template <typename... Containers>
+    void append (const Zip<Containers...>& batch)
+    {
+        static_assert(sizeof...(Containers) == sizeof...(Ts) + 1, "The batch must have a key and all the other columns");
+
+        append(batch, std::make_index_sequence<sizeof...(Ts) + 1>());
+
+        checkDelta();
+    }
+
+
+
+    /// Sorts the delta and merges it into the main table
+    void merge ()
+    {
+        merge(std::make_index_sequence<sizeof...(Ts) + 1>());
+    }
+
+
+
+    /// Number of rows in the main table and in the delta
+    std::size_t size () const { return std::get<0>(main).size() + deltaSize(); }
+
+    std::size_t deltaSize () const { return std::get<0>(delta).size(); }
+
+
+
+    /// Number of rows with the given key, in the main table and in the delta
+    std::size_t count (const Key& key)
+    {
+        return forEachMatch(key, [](const auto&...){});
+    }
+
+    bool contains (const Key& key) { return count(key) != 0; }
+
+
+    /** Calls 'f(key, values...)' for each row with the given key, first
+      * the ones of the main table in order and then the ones of the delta.
+      * Returns the number of rows found.
+    */
+    template <class F>
+    std::size_t forEachMatch (const Key& key, F f)
+    {
+        return forEachMatch(key, f, std::make_index_sequence<sizeof...(Ts) + 1>());
+    }
+
+
+
+    /** The main table as a zipped range, sorted by the key. Rows still in
+      * the delta are not included, so call 'merge' before if needed.
+    */
+    auto table () const { return table(std::make_index_sequence<sizeof...(Ts) + 1>()); }
+
+    /// The I-th column of the main table
+    template <std::size_t I>
+    const auto& column () const { return std::get<I>(main); }
+
+
+
+private:
+
+    using Columns = std::tuple< std::vector< Key >, std::vector< Ts >... >;
+
+    void checkDelta ()
+    {
+        if(deltaSize() > maxDelta)
+            merge();
+    }
+
+
+    template <std::size_t... Is>
+    void insert (std::index_sequence<Is...>, const Ts&... values)
+    {
+        const auto& dummie = { int{}, ( std::get<Is + 1>(delta).push_back(values), int{} )... };
+    }
+
+
+    template <typename... Containers, std::size_t... Is>
+    void append (const Zip<Containers...>& batch, std::index_sequence<Is...>)
+    {
+        const auto& dummie = { ( std::get<Is>(delta).insert(std::get<Is>(delta).end(), help::begin(batch.template get<Is>()),
+                                                            help::begin(batch.template get<Is>()) + batch.size()), int{} )... };
+    }
+
+
+    /// Sorts the positions of the delta rows added since the last call, and merges them with the ones before
+    void sortOrder ()
+    {
+        const auto& newKeys = std::get<0>(delta);
+
+        std::size_t first = order.size();
+
+        if(first == newKeys.size())
+            return;
+
+        auto byKey = [&](std::size_t i, std::size_t j){ return compare(newKeys[i], newKeys[j]); };
+
+        for(std::size_t i = first; i < newKeys.size(); ++i)
+            order.push_back(i);
+
+        std::stable_sort(order.begin() + first, order.end(), byKey);
+
+        std::inplace_merge(order.begin(), order.begin() + first, order.end(), byKey);
+    }
+
+
+    template <std::size_t... Is>
+    void moveRow (Columns& from, std::size_t i, std::size_t k, std::index_sequence<Is...>)
+    {
+        const auto& dummie = { ( std::get<Is>(main)[k] = std::move(std::get<Is>(from)[i]), int{} )... };
+    }
+
+
+    template <std::size_t... Is>
+    void merge (std::index_sequence<Is...> is)
+    {
+        std::size_t n = std::get<0>(main).size(), d = deltaSize();
+
+        if(!d)
+            return;
+
+        sortOrder();
+
+        const auto& dummie = { ( std::get<Is>(main).resize(n + d), int{} )... };
+
+        const auto& keys = std::get<0>(main);
+        const auto& newKeys = std::get<0>(delta);
+
+
+        /// From the back, so each row of the main table moves at most once. On ties the delta row goes last
+        for(std::size_t i = n, j = d, k = n + d; j > 0; --k)
+        {
+            if(i > 0 && compare(newKeys[order[j-1]], keys[i-1]))
+                moveRow(main, --i, k - 1, is);
+
+            else
+                moveRow(delta, order[--j], k - 1, is);
+        }
+
+
+        const auto& dummie2 = { ( std::get<Is>(delta).clear(), int{} )... };
+
+        order.clear();
+    }
+
+
+    template <class F, std::size_t... Is>
+    std::size_t forEachMatch (const Key& key, F& f, std::index_sequence<Is...>)
+    {
+        sortOrder();
+
+        /// The rows are given as const, so the keys can not be changed through 'f'
+        const Columns& mainRows = main;
+        const Columns& deltaRows = delta;
+
+        const auto& keys = std::get<0>(main);
+
+        auto range = std::equal_range(keys.begin(), keys.end(), key, compare);
+
+        for(auto i = std::size_t(range.first - keys.begin()); i < std::size_t(range.second - keys.begin()); ++i)
+            f(std::get<Is>(mainRows)[i]...);
+
+
+        const auto& newKeys = std::get<0>(delta);
+
+        auto first = std::lower_bound(order.begin(), order.end(), key, [&](std::size_t i, const Key& k){ return compare(newKeys[i], k); });
+        auto last  = std::upper_bound(first, order.end(), key, [&](const Key& k, std::size_t i){ return compare(k, newKeys[i]); });
+
+        for(auto it = first; it != last; ++it)
+            f(std::get<Is>(deltaRows)[*it]...);
+
+        return (range.second - range.first) + (last - first);
+    }
+
+
+    template <std::size_t... Is>
+    auto table (std::index_sequence<Is...>) const
+    {
+        return zip(std::get<Is>(main)...);
+    }
+
+
+
+    Compare compare;
+
+    std::size_t maxDelta;
+
+    Columns main;
+
+    Columns delta;
+
+    /// Positions of the first delta rows, sorted by key and by position on ties. The rows after them are not sorted yet
+    std::vector<std::size_t> order;
+};
+
+
+template <class Compare, typename Key, typename... Ts>
+constexpr std::size_t SortedZip<Compare, Key, Ts...>::npos;
+
+
+
+namespace help
+{
+
+template <class Compare, typename Key, typename... Ts>
+auto sortedZip (Compare compare, std::tuple<Key, Ts...>*)
+{
+    return SortedZip<Compare, Key, Ts...>(compare);
+}
+
+} // namespace help
+
+
+
+/// Creates an empty 'SortedZip' deducing the comparison type
+template <typename Key, typename... Ts, class Compare = std::less<>>
+auto makeSortedZip (Compare compare = Compare(), std::size_t maxDelta = SortedZip<Compare, Key, Ts...>::npos)
+{
+    return SortedZip<Compare, Key, Ts...>(compare, maxDelta);
+}
+
+
+/// Creates a 'SortedZip' with a copy of the rows of 'zipped', whose first column is the key
+template <class Compare = std::less<>, typename... Containers>
+auto sortedZip (const Zip<Containers...>& zipped, Compare compare = Compare())
+{
+    using Types = std::decay_t< typename Zip<Containers...>::iterator::value_type >;
+
+    auto res = help::sortedZip(compare, (Types*)nullptr);
+
+    res.append(zipped);
+    res.merge();
+
+    return res;
+}
+
+
+} // namespace it
+
+
+
+#endif // SORTED_ZIP_ITER_H
@@ -0,0 +1,145 @@
+/**
+ *  @file    Stats.h
+ *
+ *  @brief Opt in counters of the operations made on 'ZipIter'. Define
+ *         ZIPITER_STATS before including any header of the library to
+ *         turn them on. Otherwise 'ZIP_ITER_STAT' expands to nothing and
+ *         the code is exactly the same as without this header.
+ */
+
+
+
+#ifndef STATS_ZIP_ITER_H
+#define STATS_ZIP_ITER_H
+
+
+
+#ifndef ZIPITER_STATS
+
+#define ZIP_ITER_STAT(counter)
+
+#else
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+
+
+/// Increments one of the counters of the current thread
+#define ZIP_ITER_STAT(counter) (++::it::stats::local().counter)
+
+
+
+namespace it
+{
+
+namespace stats
+{
+
+/// The number of each operation made on any 'ZipIter'
+struct Counters
+{
+    std::size_t increments   = 0;     ///< operator ++
+    std::size_t decrements   = 0;     ///< operator --
+    std::size_t advances     = 0;     ///< operator += and -=, also called by + and -
+    std::size_t distances    = 0;     ///< difference of two iterators
+    std::size_t dereferences = 0;     ///< operator *
+    std::size_t comparisons  = 0;     ///< operator == and <, also called by the other comparisons
+    std::size_t swaps        = 0;     ///< swap of the tuples of references returned by operator *
+
+
+    std::size_t total () const
+    {
+        return increments + decrements + advances + distances + dereferences + comparisons + swaps;
+    }
+};
+
+
+inline Counters operator- (Counters a, const Counters& b)
+{
+    a.increments   -= b.increments;
+    a.decrements   -= b.decrements;
+    a.advances     -= b.advances;
+    a.distances    -= b.distances;
+    a.dereferences -= b.dereferences;
+    a.comparisons  -= b.comparisons;
+    a.swaps        -= b.swaps;
+
+    return a;
+}
+
+
+inline std::ostream& operator<< (std::ostream& out, const Counters& c)
+{
+    return out << "increments: "     << c.increments
+               << "  decrements: "   << c.decrements
+               << "  advances: "     << c.advances
+               << "  distances: "    << c.distances
+               << "  dereferences: " << c.dereferences
+               << "  comparisons: "  << c.comparisons
+               << "  swaps: "        << c.swaps;
+}
+
+
+
+/// The counters of the calling thread. They are only ever incremented
+inline Counters& local ()
+{
+    static thread_local Counters counters;
+
+    return counters;
+}
+
+
+
+
+/** \class Scope
+  *
+  * Measures the operations made by the current thread during its lifetime,
+  * for instance around a single call to 'std::sort'. If an output stream
+  * is given, the totals are written there on destruction, along with the name.
+*/
+class Scope
+{
+public:
+
+    Scope (std::string name = "", std::ostream* out = nullptr) : name(std::move(name)), out(out), start(local()) {}
+
+    ~Scope ()
+    {
+        if(out)
+            *out << name << (name.empty() ? "" : ": ") << counts() << "\n";
+    }
+
+
+    Scope (const Scope&) = delete;
+
+    Scope& operator= (const Scope&) = delete;
+
+
+
+    /// The operations made since the creation of the scope
+    Counters counts () const { return local() - start; }
+
+
+
+private:
+
+    std::string name;
+
+    std::ostream* out;
+
+    Counters start;
+};
+
+
+} // namespace stats
+
+} // namespace it
+
+
+#endif // ZIPITER_STATS
+
+
+
+#endif // STATS_ZIP_ITER_H
@@ -0,0 +1,392 @@
+/**
+ *  @file    StringColumn.h
+ *
+ *  @brief A column of variable length strings stored in a single byte
+ *         blob plus an array of offsets, that can be zipped with other
+ *         columns. Each string also keeps its first bytes inline, so most
+ *         comparisons are decided without reading the blob.
+ */
+
+
+
+#ifndef STRING_COLUMN_ZIP_ITER_H
+#define STRING_COLUMN_ZIP_ITER_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <ostream>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+
+#if __cplusplus >= 201703L
+    #include <string_view>
+#endif
+
+#include "ZipIter.h"
+#include "ScratchArena.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/// The first 8 bytes of a string as a big endian integer, padded with zeros, so integer order is byte order
+inline std::uint64_t stringPrefix (const char* data, std::size_t size)
+{
+    std::uint64_t prefix = 0;
+
+    for(std::size_t k = 0; k < 8; ++k)
+        prefix = (prefix << 8) | (k < size ? std::uint64_t(static_cast<unsigned char>(data[k])) : 0);
+
+    return prefix;
+}
+
+} // namespace help
+
+
+
+
+/** \class StringRef
+  *
+  * A read only reference to a string (a pointer and a size), carrying its
+  * prefix: the first 8 bytes packed in an integer. The comparisons look at
+  * the prefixes first and only read the characters when they are equal.
+  * This is the 'std::string_view' of the columns, and converts to it in C++17.
+*/
+class StringRef
+{
+public:
+
+    StringRef () = default;
+
+    StringRef (const char* data, std::size_t size) : first(data), n(size), pre(help::stringPrefix(data, size)) {}
+
+    StringRef (const char* data, std::size_t size, std::uint64_t prefix) : first(data), n(size), pre(prefix) {}
+
+    StringRef (const char* str) : StringRef(str, std::strlen(str)) {}
+
+    StringRef (const std::string& str) : StringRef(str.data(), str.size()) {}
+
+
+
+    const char* data () const { return first; }
+
+    std::size_t size () const { return n; }
+
+    bool empty () const { return !n; }
+
+    std::uint64_t prefix () const { return pre; }
+
+
+    const char* begin () const { return first; }
+
+    const char* end () const { return first + n; }
+
+    char operator [] (std::size_t pos) const { return first[pos]; }
+
+
+    std::string str () const { return std::string(first, n); }
+
+    operator std::string () const { return str(); }
+
+#if __cplusplus >= 201703L
+    operator std::string_view () const { return std::string_view(first, n); }
+#endif
+
+
+
+    /// Negative, zero or positive, as in 'std::string::compare'
+    int compare (const StringRef& other) const
+    {
+        if(pre != other.pre)
+            return pre < other.pre ? -1 : 1;
+
+        std::size_t common = std::min(n, other.n);
+
+        if(common > 8)
+            if(int res = std::memcmp(first + 8, other.first + 8, common - 8))
+                return res;
+
+        return n < other.n ? -1 : (n > other.n ? 1 : 0);
+    }
+
+
+    friend bool operator == (const StringRef& a, const StringRef& b)
+    {
+        return a.pre == b.pre && a.n == b.n && (a.n <= 8 || !std::memcmp(a.first + 8, b.first + 8, a.n - 8));
+    }
+
+    friend bool operator != (const StringRef& a, const StringRef& b) { return !(a == b); }
+    friend bool operator <  (const StringRef& a, const StringRef& b) { return a.compare(b) <  0; }
+    friend bool operator >  (const StringRef& a, const StringRef& b) { return a.compare(b) >  0; }
+    friend bool operator <= (const StringRef& a, const StringRef& b) { return a.compare(b) <= 0; }
+    friend bool operator >= (const StringRef& a, const StringRef& b) { return a.compare(b) >= 0; }
+
+
+    friend std::ostream& operator << (std::ostream& out, const StringRef& s) { return out.write(s.first, s.n); }
+
+
+private:
+
+    const char* first = nullptr;
+
+    std::size_t n = 0;
+
+    std::uint64_t pre = 0;
+};
+
+
+
+
+class StringColumn;
+
+
+namespace help
+{
+
+/** \class StringColumnIter
+  *
+  * Random access iterator over a 'StringColumn', giving a const 'StringRef'
+  * by value. Building it reads the offsets and the prefix of the row, but
+  * not the blob. The strings can not be assigned through it, so the std
+  * algorithms that move elements do not compile on it.
+*/
+template <class Column>
+class StringColumnIter
+{
+public:
+
+    using iterator_category = std::random_access_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = StringRef;
+    using reference         = const StringRef;
+    using pointer           = void;
+
+
+    StringColumnIter () = default;
+
+    StringColumnIter (Column* column, std::size_t pos) : col(column), pos(pos) {}
+
+
+
+    reference operator * () const { return (*col)[pos]; }
+
+    reference operator [] (difference_type inc) const { return (*col)[pos + inc]; }
+
+
+    StringColumnIter& operator ++ () { ++pos; return *this; }
+    StringColumnIter& operator -- () { --pos; return *this; }
+
+    StringColumnIter operator ++ (int) { StringColumnIter temp{ *this }; ++pos; return temp; }
+    StringColumnIter operator -- (int) { StringColumnIter temp{ *this }; --pos; return temp; }
+
+    StringColumnIter& operator += (difference_type inc) { pos += inc; return *this; }
+    StringColumnIter& operator -= (difference_type inc) { pos -= inc; return *this; }
+
+
+    friend StringColumnIter operator + (StringColumnIter it, difference_type inc) { return it += inc; }
+    friend StringColumnIter operator + (difference_type inc, StringColumnIter it) { return it += inc; }
+    friend StringColumnIter operator - (StringColumnIter it, difference_type inc) { return it -= inc; }
+
+    friend difference_type operator - (const StringColumnIter& a, const StringColumnIter& b) { return difference_type(a.pos) - difference_type(b.pos); }
+
+
+    friend bool operator == (const StringColumnIter& a, const StringColumnIter& b) { return a.pos == b.pos; }
+    friend bool operator != (const StringColumnIter& a, const StringColumnIter& b) { return a.pos != b.pos; }
+    friend bool operator <  (const StringColumnIter& a, const StringColumnIter& b) { return a.pos <  b.pos; }
+    friend bool operator >  (const StringColumnIter& a, const StringColumnIter& b) { return a.pos >  b.pos; }
+    friend bool operator <= (const StringColumnIter& a, const StringColumnIter& b) { return a.pos <= b.pos; }
+    friend bool operator >= (const StringColumnIter& a, const StringColumnIter& b) { return a.pos >= b.pos; }
+
+
+    Column& column () const { return *col; }
+
+    std::size_t position () const { return pos; }
+
+
+private:
+
+    Column* col = nullptr;
+
+    std::size_t pos = 0;
+};
+
+} // namespace help
+
+
+
+
+/** \class StringColumn
+  *
+  * The strings of a column one after the other in a single blob, with the
+  * offset where each one starts and its prefix in two separated arrays
+  * (as Arrow does for its string arrays). Appending costs no allocation per
+  * row, and scanning or sorting reads the offsets and prefixes sequentially,
+  * going to the blob only for strings sharing their first 8 bytes.
+  *
+  * It can be passed to 'zip' with any other column. The elements are
+  * 'StringRef's, valid until the column is modified. As they can not be
+  * assigned, the column can not be sorted by the std algorithms through a
+  * 'ZipIter', but 'argsort', 'sort', 'merge' and 'partition' of 'ScratchArena.h'
+  * handle it, permuting the whole column at once.
+*/
+class StringColumn
+{
+public:
+
+    using value_type = StringRef;
+
+    using iterator = help::StringColumnIter< StringColumn >;
+
+    using const_iterator = help::StringColumnIter< const StringColumn >;
+
+
+
+    StringColumn () : offsets(1, 0) {}
+
+    StringColumn (std::initializer_list<StringRef> strings) : StringColumn()
+    {
+        for(const auto& s : strings)
+            push_back(s);
+    }
+
+    template <class Iter>
+    StringColumn (Iter first, Iter last) : StringColumn()
+    {
+        for(; first != last; ++first)
+            push_back(*first);
+    }
+
+
+
+    /// Room for 'rows' strings with 'bytes' characters in total
+    void reserve (std::size_t rows, std::size_t bytes = 0)
+    {
+        offsets.reserve(rows + 1);
+        prefixes.reserve(rows);
+        blob.reserve(bytes);
+    }
+
+
+    void push_back (const StringRef& s) { append(s.data(), s.size()); }
+
+    void append (const char* data, std::size_t size)
+    {
+        blob.insert(blob.end(), data, data + size);
+
+        offsets.push_back(blob.size());
+
+        prefixes.push_back(help::stringPrefix(data, size));
+    }
+
+
+    void clear ()
+    {
+        blob.clear();
+        prefixes.clear();
+        offsets.assign(1, 0);
+    }
+
+
+
+    StringRef operator [] (std::size_t pos) const
+    {
+        return StringRef(blob.data() + offsets[pos], offsets[pos+1] - offsets[pos], prefixes[pos]);
+    }
+
+
+    iterator begin () { return iterator(this, 0); }
+
+    iterator end () { return iterator(this, size()); }
+
+    const_iterator begin () const { return const_iterator(this, 0); }
+
+    const_iterator end () const { return const_iterator(this, size()); }
+
+
+    std::size_t size () const { return prefixes.size(); }
+
+    bool empty () const { return prefixes.empty(); }
+
+    /// Total number of characters
+    std::size_t bytes () const { return blob.size(); }
+
+
+
+    /** Moves the string at 'perm[i]' to the row 'i', for a permutation 'perm'
+      * of the first 'n' rows. The rows after them are not touched. The new
+      * blob, offsets and prefixes of those rows are built in 'arena' and then
+      * copied back, so no heap allocation is made.
+    */
+    void permute (const std::size_t* perm, std::size_t n, ScratchArena& arena)
+    {
+        ScratchArena::Scope scope(arena);
+
+        std::size_t bytes = offsets[n];
+
+        char* newBlob = arena.allocate<char>(bytes);
+        std::size_t* newOffsets = arena.allocate<std::size_t>(n + 1);
+        std::uint64_t* newPrefixes = arena.allocate<std::uint64_t>(n);
+
+        newOffsets[0] = 0;
+
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t first = offsets[perm[i]], len = offsets[perm[i]+1] - first;
+
+            if(len)
+                std::memcpy(newBlob + newOffsets[i], blob.data() + first, len);
+
+            newOffsets[i+1] = newOffsets[i] + len;
+            newPrefixes[i] = prefixes[perm[i]];
+        }
+
+        std::copy(newBlob, newBlob + bytes, blob.begin());
+        std::copy(newOffsets, newOffsets + n + 1, offsets.begin());
+        std::copy(newPrefixes, newPrefixes + n, prefixes.begin());
+    }
+
+    /// The same for a permutation of all the rows
+    void permute (const std::size_t* perm, ScratchArena& arena) { permute(perm, size(), arena); }
+
+
+
+private:
+
+    std::vector<char> blob;
+
+    std::vector<std::size_t> offsets;
+
+    std::vector<std::uint64_t> prefixes;
+};
+
+
+
+namespace help
+{
+
+/** The algorithms of 'ScratchArena.h' permute the first 'n' rows of a 'StringColumn' at once,
+  * found through the iterator type. 'n' is the size of the zip, which may be shorter than the column
+*/
+template <class Column>
+void permuteColumn (StringColumnIter<Column> column, const std::size_t* perm, std::size_t n, ScratchArena& arena)
+{
+    static_assert(!std::is_const<Column>::value, "A const StringColumn can not be permuted");
+
+    column.column().permute(perm, n, arena);
+}
+
+} // namespace help
+
+
+} // namespace it
+
+
+
+#endif // STRING_COLUMN_ZIP_ITER_H
@@ -0,0 +1,387 @@
+/**
+ *  @file    TopK.h
+ *
+ *  @brief Selection of the best k rows of a zipped range. Only the key
+ *         column (the first one) takes part in the comparisons, and the
+ *         other columns are touched just for the winners.
+ */
+
+
+
+#ifndef TOP_K_ZIP_ITER_H
+#define TOP_K_ZIP_ITER_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+namespace help
+{
+
+/// A key along with the row it came from
+template <typename Key>
+struct KeyIndex
+{
+    Key key;
+
+    std::size_t index;
+};
+
+
+/** Orders 'KeyIndex' by the key, breaking ties by the row. This way
+  * the selection gives the same rows as a stable sort would.
+*/
+template <class Compare>
+struct KeyIndexCompare
+{
+    template <typename Key>
+    bool operator () (const KeyIndex<Key>& a, const KeyIndex<Key>& b) const
+    {
+        if(compare(a.key, b.key)) return true;
+        if(compare(b.key, a.key)) return false;
+
+        return a.index < b.index;
+    }
+
+    Compare compare;
+};
+
+
+
+/** Selects the k best (key, row) pairs of the first n keys. For small k
+  * a bounded heap is used, so only O(k) memory is needed. Otherwise all
+  * the pairs are copied and the selection is made via introselect.
+*/
+template <class Iter, class Compare>
+auto selectKeys (Iter first, std::size_t n, std::size_t k, Compare compare, bool sorted)
+{
+    using Key = typename std::iterator_traits<Iter>::value_type;
+
+    KeyIndexCompare<Compare> comp{ compare };
+
+    std::vector<KeyIndex<Key>> sel;
+
+    k = std::min(k, n);
+
+    if(k == 0)
+        return sel;
+
+
+    /// The heap is worth it while it stays small compared to the input
+    if(k <= n / 16)
+    {
+        sel.reserve(k);
+
+        std::size_t i = 0;
+
+        for(; i < k; ++i, ++first)
+            sel.push_back({ *first, i });
+
+        std::make_heap(sel.begin(), sel.end(), comp);
+
+        for(; i < n; ++i, ++first) if(compare(*first, sel.front().key))
+        {
+            std::pop_heap(sel.begin(), sel.end(), comp);
+
+            sel.back() = { *first, i };
+
+            std::push_heap(sel.begin(), sel.end(), comp);
+        }
+
+        if(sorted)
+            std::sort_heap(sel.begin(), sel.end(), comp);
+    }
+
+    else
+    {
+        sel.reserve(n);
+
+        for(std::size_t i = 0; i < n; ++i, ++first)
+            sel.push_back({ *first, i });
+
+        std::nth_element(sel.begin(), sel.begin() + (k - 1), sel.end(), comp);
+
+        sel.resize(k);
+
+        if(sorted)
+            std::sort(sel.begin(), sel.end(), comp);
+    }
+
+    return sel;
+}
+
+
+template <typename Key>
+std::vector<std::size_t> keyRows (const std::vector<KeyIndex<Key>>& sel)
+{
+    std::vector<std::size_t> rows(sel.size());
+
+    std::transform(sel.begin(), sel.end(), rows.begin(), [](const auto& ki){ return ki.index; });
+
+    return rows;
+}
+
+
+
+/** Places the given rows (in that order) at the front of a single column.
+  * The rows that were at the front and are not selected fill the holes
+  * left by the selected rows, so the column stays a permutation of itself.
+  * Only O(k) elements are moved.
+*/
+template <class Iter>
+void moveToFront (Iter first, const std::vector<std::size_t>& rows,
+                  const std::vector<std::size_t>& holes, const std::vector<std::size_t>& losers)
+{
+    using T = typename std::iterator_traits<Iter>::value_type;
+
+    std::vector<T> winners;
+
+    winners.reserve(rows.size());
+
+    for(auto row : rows)
+        winners.push_back(std::move(first[row]));
+
+    for(std::size_t i = 0; i < holes.size(); ++i)
+        first[holes[i]] = std::move(first[losers[i]]);
+
+    std::move(winners.begin(), winners.end(), first);
+}
+
+
+template <class ZipT, std::size_t... Is>
+void moveRowsToFront (ZipT& zipped, const std::vector<std::size_t>& rows, std::index_sequence<Is...>)
+{
+    std::size_t k = rows.size();
+
+    std::vector<char> taken(k, 0);
+    std::vector<std::size_t> holes, losers;
+
+    for(auto row : rows)
+    {
+        if(row < k) taken[row] = 1;
+        else        holes.push_back(row);
+    }
+
+    for(std::size_t i = 0; i < k; ++i) if(!taken[i])
+        losers.push_back(i);
+
+    const auto& dummie = { ( moveToFront(help::begin( zipped.template get<Is>() ), rows, holes, losers), int{} )... };
+}
+
+} // namespace help
+
+
+
+
+/** Returns the rows of the k best keys of 'zipped' in order. The key is
+  * the first column, and 'compare' has the same meaning as in 'std::partial_sort',
+  * so the default gives the k smallest keys. Ties are broken by the row.
+*/
+template <class Compare = std::less<>, typename... Containers>
+std::vector<std::size_t> topKRows (const Zip<Containers...>& zipped, std::size_t k, Compare compare = Compare())
+{
+    return help::keyRows(help::selectKeys(help::begin(zipped.template get<0>()), zipped.size(), k, compare, true));
+}
+
+
+
+/** Returns a tuple of std::vector's containing the k best rows of all
+  * columns, sorted by the key. The payload is gathered only for the winners.
+*/
+template <class Compare = std::less<>, typename... Containers>
+auto topK (const Zip<Containers...>& zipped, std::size_t k, Compare compare = Compare())
+{
+    return help::gatherRows(zipped, topKRows(zipped, k, compare), std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+
+/** The same as 'std::partial_sort(ZIP_ALL(...), compare)' using 'k' as
+  * the middle point. The selection is made on the key column only and
+  * each column is then permuted separately, moving O(k) elements.
+*/
+template <class Compare = std::less<>, typename... Containers>
+void partialSort (Zip<Containers...> zipped, std::size_t k, Compare compare = Compare())
+{
+    help::moveRowsToFront(zipped, topKRows(zipped, k, compare), std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+
+/** The same as 'std::nth_element(ZIP_ALL(...), compare)'. After the call
+  * the row at position 'nth' is the one that would be there if the range
+  * were sorted, the ones before are not greater and the ones after are not smaller.
+*/
+template <class Compare = std::less<>, typename... Containers>
+void nthElement (Zip<Containers...> zipped, std::size_t nth, Compare compare = Compare())
+{
+    if(nth >= zipped.size())
+        return;
+
+    auto sel = help::selectKeys(help::begin(zipped.template get<0>()), zipped.size(), nth + 1, compare, false);
+
+    std::iter_swap(std::max_element(sel.begin(), sel.end(), help::KeyIndexCompare<Compare>{ compare }), sel.end() - 1);
+
+    help::moveRowsToFront(zipped, help::keyRows(sel), std::make_index_sequence<sizeof...(Containers)>());
+}
+
+
+
+
+
+/** \class TopK
+  *
+  * Streaming version of 'topK'. Batches of rows are pushed one at a time
+  * as zipped ranges of (key, payload...) and only the k best rows seen so
+  * far are kept, so the memory used is O(k) no matter how many rows are pushed.
+  * The payload of a row is copied only when it enters the current top k.
+*/
+template <class Compare, typename Key, typename... Payload>
+class TopK
+{
+public:
+
+    /// The result type. The first column holds the keys.
+    using result_type = std::tuple< std::vector< Key >, std::vector< Payload >... >;
+
+
+    TopK (std::size_t k, Compare compare = Compare()) : k(k), comp{ compare }
+    {
+        heap.reserve(k);
+
+        reserve(std::make_index_sequence<sizeof...(Payload)>());
+    }
+
+
+
+    /// Pushes a new batch, whose first column is the key column
+    template <typename... Containers>
+    void push (const Zip<Containers...>& batch)
+    {
+        static_assert(sizeof...(Containers) == sizeof...(Payload) + 1, "The batch must have a key and all payload columns");
+
+        push(batch, std::make_index_sequence<sizeof...(Payload)>());
+    }
+
+
+
+    /// Returns the current k best rows, sorted by the key
+    result_type result () const
+    {
+        auto sorted = heap;
+
+        std::sort_heap(sorted.begin(), sorted.end(), comp);
+
+        return result(sorted, std::make_index_sequence<sizeof...(Payload)>());
+    }
+
+
+    /// Number of rows currently kept and total number of rows seen
+    std::size_t size () const { return heap.size(); }
+
+    std::size_t seen () const { return count; }
+
+
+
+private:
+
+    /// The index of the 'KeyIndex' is the global position of the row, and 'slot' is where its payload is kept
+    struct Entry : help::KeyIndex<Key>
+    {
+        Entry (const Key& key, std::size_t index, std::size_t slot) : help::KeyIndex<Key>{ key, index }, slot(slot) {}
+
+        std::size_t slot;
+    };
+
+
+    template <typename... Containers, std::size_t... Is>
+    void push (const Zip<Containers...>& batch, std::index_sequence<Is...>)
+    {
+        auto keys = help::begin(batch.template get<0>());
+
+        for(std::size_t i = 0, n = batch.size(); i < n; ++i, ++count)
+        {
+            const Key& key = keys[i];
+
+            if(heap.size() < k)
+            {
+                const auto& dummie = { int{}, ( std::get<Is>(payload).push_back( help::begin( batch.template get<Is + 1>() )[i] ), int{} )... };
+
+                heap.emplace_back(key, count, heap.size());
+
+                std::push_heap(heap.begin(), heap.end(), comp);
+            }
+
+            else if(k && comp.compare(key, heap.front().key))
+            {
+                std::pop_heap(heap.begin(), heap.end(), comp);
+
+                std::size_t slot = heap.back().slot;
+
+                const auto& dummie = { int{}, ( std::get<Is>(payload)[slot] = help::begin( batch.template get<Is + 1>() )[i], int{} )... };
+
+                heap.back() = Entry(key, count, slot);
+
+                std::push_heap(heap.begin(), heap.end(), comp);
+            }
+        }
+    }
+
+
+    template <std::size_t... Is>
+    result_type result (const std::vector<Entry>& sorted, std::index_sequence<Is...>) const
+    {
+        result_type res;
+
+        for(const auto& entry : sorted)
+        {
+            std::get<0>(res).push_back(entry.key);
+
+            const auto& dummie = { int{}, ( std::get<Is + 1>(res).push_back( std::get<Is>(payload)[entry.slot] ), int{} )... };
+        }
+
+        return res;
+    }
+
+
+    template <std::size_t... Is>
+    void reserve (std::index_sequence<Is...>)
+    {
+        const auto& dummie = { int{}, ( std::get<Is>(payload).reserve(k), int{} )... };
+    }
+
+
+
+    std::size_t k;
+
+    std::size_t count = 0;
+
+    help::KeyIndexCompare<Compare> comp;
+
+    std::vector<Entry> heap;
+
+    std::tuple< std::vector< Payload >... > payload;
+};
+
+
+
+/// Creates a 'TopK' deducing the comparison type
+template <typename Key, typename... Payload, class Compare = std::less<>>
+auto makeTopK (std::size_t k, Compare compare = Compare())
+{
+    return TopK<Compare, Key, Payload...>(k, compare);
+}
+
+
+} // namespace it
+
+
+
+#endif // TOP_K_ZIP_ITER_H
@@ -0,0 +1,242 @@
+/**
+ *  @file    Zip2d.h
+ *
+ *  @brief Traversal of several row major matrices of the same shape, stored
+ *         as flat containers, in row major, column major or cache blocked
+ *         order, giving the indices and the elements of each position.
+ */
+
+
+
+#ifndef ZIP_2D_ZIP_ITER_H
+#define ZIP_2D_ZIP_ITER_H
+
+#include <cmath>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(__linux__)
+    #include <unistd.h>
+#endif
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/// The order in which 'Zip2d::forEach' visits the positions of the matrices
+enum class Traversal
+{
+    rowMajor,
+    columnMajor,
+    tiled
+};
+
+
+
+namespace help
+{
+
+/// Size in bytes of the data cache of the given level (1 or 2), or a usual size if it can not be queried
+inline std::size_t dataCacheSize (int level)
+{
+    long bytes = 0;
+
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+    bytes = ::sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+#endif
+
+    return bytes > 0 ? std::size_t(bytes) : (level == 1 ? std::size_t(32) << 10 : std::size_t(256) << 10);
+}
+
+
+/** Side of a square tile such that a tile of every matrix, and as much again
+  * for a transposed access to other data, fits in 'cacheBytes'. It is a
+  * multiple of 'multiple' and at least 'multiple'.
+*/
+inline std::size_t tileSide (std::size_t cacheBytes, std::size_t rowBytes, std::size_t multiple)
+{
+    std::size_t side = std::size_t(std::sqrt(double(cacheBytes) / (2 * rowBytes)));
+
+    return std::max(multiple, side / multiple * multiple);
+}
+
+} // namespace help
+
+
+
+
+/** \class Zip2d
+  *
+  * A view of the zipped containers as 'rows' x 'cols' matrices in row major
+  * order. 'forEach' calls a function with '(i, j, elems...)' for every
+  * position, where 'elems' are references to the elements at row 'i' and
+  * column 'j' of each matrix, in the chosen traversal order.
+  *
+  * The tiled order walks blocks sized for the L2 cache, and inside each
+  * block, square tiles sized for the L1 cache, row by row. A function that
+  * reads one matrix in row order and writes another in column order (a
+  * transpose) then touches the same few cache lines of both while a tile
+  * is visited, instead of one line per element of the column order side.
+*/
+template <typename... Containers>
+class Zip2d
+{
+public:
+
+    using ZipT = Zip<Containers...>;
+
+
+    Zip2d (std::size_t numRows, std::size_t numCols, ZipT zipped) : numRows(numRows), numCols(numCols), zipped(zipped)
+    {
+        checkSizes(std::index_sequence_for<Containers...>());
+
+        std::size_t rowBytes = elementBytes(std::index_sequence_for<Containers...>());
+
+        l1Side = help::tileSide(help::dataCacheSize(1), rowBytes, 8);
+        l2Side = help::tileSide(help::dataCacheSize(2), rowBytes, l1Side);
+    }
+
+
+
+    /// Calls 'f(i, j, elems...)' for every position, in the given order
+    template <class F>
+    void forEach (F f, Traversal order = Traversal::tiled) const
+    {
+        if(order == Traversal::tiled)
+            return forEachTiled(f, l1Side, l2Side);
+
+        auto firsts = begins(std::index_sequence_for<Containers...>());
+
+        if(order == Traversal::rowMajor)
+            visit(f, firsts, 0, numRows, 0, numCols);
+
+        else
+        {
+            for(std::size_t j = 0; j < numCols; ++j)
+                for(std::size_t i = 0; i < numRows; ++i)
+                    call(f, firsts, i, j, std::index_sequence_for<Containers...>());
+        }
+    }
+
+
+    /// The tiled order with the given sides of the tiles and of the blocks of tiles
+    template <class F>
+    void forEachTiled (F f, std::size_t tile, std::size_t block) const
+    {
+        if(!tile || block < tile)
+            throw std::runtime_error("The tile side must be positive and at most the block side");
+
+        auto firsts = begins(std::index_sequence_for<Containers...>());
+
+        for(std::size_t bi = 0; bi < numRows; bi += block)
+            for(std::size_t bj = 0; bj < numCols; bj += block)
+            {
+                std::size_t ei = std::min(numRows, bi + block), ej = std::min(numCols, bj + block);
+
+                for(std::size_t ti = bi; ti < ei; ti += tile)
+                    for(std::size_t tj = bj; tj < ej; tj += tile)
+                        visit(f, firsts, ti, std::min(ei, ti + tile), tj, std::min(ej, tj + tile));
+            }
+    }
+
+
+
+    /// Tuple of references to the elements at row 'i' and column 'j'
+    auto operator () (std::size_t i, std::size_t j) const { return zipped[i * numCols + j]; }
+
+
+    std::size_t rows () const { return numRows; }
+
+    std::size_t cols () const { return numCols; }
+
+
+    /// The sides of the L1 tiles and of the L2 blocks used by the tiled order
+    std::size_t tileSide () const { return l1Side; }
+
+    std::size_t blockSide () const { return l2Side; }
+
+
+    const ZipT& matrices () const { return zipped; }
+
+
+
+private:
+
+    template <std::size_t... Is>
+    void checkSizes (std::index_sequence<Is...>) const
+    {
+        const auto& dummie = { int{}, ( zipped.template get<Is>().size() < numRows * numCols ?
+                               throw std::runtime_error("A matrix has fewer than rows * cols elements") : int{} )... };
+    }
+
+    template <std::size_t... Is>
+    static std::size_t elementBytes (std::index_sequence<Is...>)
+    {
+        std::size_t bytes = 0;
+
+        const auto& dummie = { int{}, ( bytes += sizeof(help::ColumnType<ZipT, Is>), int{} )... };
+
+        return bytes;
+    }
+
+    template <std::size_t... Is>
+    auto begins (std::index_sequence<Is...>) const
+    {
+        return std::make_tuple( help::begin( zipped.template get<Is>() )... );
+    }
+
+
+    template <class F, class Firsts, std::size_t... Is>
+    void call (F& f, const Firsts& firsts, std::size_t i, std::size_t j, std::index_sequence<Is...>) const
+    {
+        std::size_t pos = i * numCols + j;
+
+        f(i, j, std::get<Is>(firsts)[pos]...);
+    }
+
+    /// Row major visit of the rows [i0, i1) and columns [j0, j1)
+    template <class F, class Firsts>
+    void visit (F& f, const Firsts& firsts, std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1) const
+    {
+        for(std::size_t i = i0; i < i1; ++i)
+            for(std::size_t j = j0; j < j1; ++j)
+                call(f, firsts, i, j, std::index_sequence_for<Containers...>());
+    }
+
+
+
+    std::size_t numRows, numCols;
+
+    ZipT zipped;
+
+    std::size_t l1Side, l2Side;
+};
+
+
+
+
+/** Views the flat containers 'mats', each with at least 'rows * cols'
+  * elements, as row major matrices of that shape:
+  *
+  *     zip2d(n, m, a, b, c).forEach([&](std::size_t i, std::size_t j, double x, double y, double& z)
+  *     {
+  *         z = x + y;
+  *         t[j * n + i] = x;
+  *     });
+*/
+template <typename... Containers>
+auto zip2d (std::size_t rows, std::size_t cols, Containers&&... mats)
+{
+    return Zip2d<Containers...>(rows, cols, zip(std::forward<Containers>(mats)...));
+}
+
+
+} // namespace it
+
+
+
+#endif // ZIP_2D_ZIP_ITER_H
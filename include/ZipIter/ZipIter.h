@@ -64,6 +64,8 @@ public:
         */
         ZipIter& operator ++ ()
         {
+            ZIP_ITER_STAT(increments);
+
             help::execTuple(help::increment, iters); return *this;
         }
 
@@ -80,6 +82,8 @@ public:
         template <class Tag = iterator_category, help::EnableIfMinimumTag< Tag, std::bidirectional_iterator_tag > = 0 >
         ZipIter& operator -- ()
         {
+            ZIP_ITER_STAT(decrements);
+
             help::execTuple(help::decrement, iters); return *this;
         }
 
@@ -97,6 +101,8 @@ public:
         template <class Tag = iterator_category, help::EnableIfMinimumTag< Tag, std::random_access_iterator_tag > = 0 >
         ZipIter& operator += (int inc)
         {
+          ZIP_ITER_STAT(advances);
+
           help::execTuple(help::add, iters, inc);
 
           return *this;
@@ -105,6 +111,8 @@ public:
         template <class Tag = iterator_category, help::EnableIfMinimumTag< Tag, std::random_access_iterator_tag > = 0 >
         ZipIter& operator -= (int inc)
         {
+            ZIP_ITER_STAT(advances);
+
             help::execTuple(help::add, iters, -inc);
 
             return *this;
@@ -140,31 +148,42 @@ public:
         */
         decltype(auto) operator * ()
         {
+        	ZIP_ITER_STAT(dereferences);
+
         	return dereference( std::make_index_sequence< sizeof... (Iters) + 1 >() );
         }
 
         decltype(auto) operator * () const
         {
+        	ZIP_ITER_STAT(dereferences);
+
         	return dereference( std::make_index_sequence< sizeof... (Iters) + 1 >() );
         }
 
 
+        /// The tuple of underlying iterators, used to flatten a 'ZipIter' passed to 'zipIter'
+        const iters_type& iterators () const { return iters; }
+
+
 
 private:
 
 
 
-    /// Here the tuple of value is returned as a temporary to avoid any extra extorage or access
+    /** Here the tuple of value is returned as a temporary to avoid any extra extorage or access.
+      * Iterators returning references give references, and proxy iterators returning
+      * values (like 'StringColumn') give the values themselves, which would dangle otherwise.
+    */
     template <std::size_t... Is>
     auto dereference (std::index_sequence<Is...>)
     {
-        return std::forward_as_tuple( *std::get< Is >( iters )... );
+        return std::tuple< decltype( *std::get< Is >( iters ) )... >( *std::get< Is >( iters )... );
     }
 
     template <std::size_t... Is>
     auto dereference (std::index_sequence<Is...>) const
     {
-        return std::forward_as_tuple( *std::get< Is >( iters )... );
+        return std::tuple< decltype( *std::get< Is >( iters ) )... >( *std::get< Is >( iters )... );
     }
 
 
@@ -204,6 +223,8 @@ inline auto operator+ (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iters
 template <typename T, typename... Iters>
 inline auto operator- (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iters...>& iter2)
 {
+	ZIP_ITER_STAT(distances);
+
 	return std::get<0>(iter1.iters) - std::get<0>(iter2.iters);
 }
 
@@ -212,6 +233,8 @@ inline auto operator- (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iters
 template <typename T, typename... Iters>
 inline bool operator== (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iters...>& iter2)
 {
+	ZIP_ITER_STAT(comparisons);
+
 	return std::get<0>(iter1.iters) == std::get<0>(iter2.iters);
 }
 
@@ -225,6 +248,8 @@ inline bool operator!= (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iter
 template <typename T, typename... Iters>
 inline bool operator< (const ZipIter<T, Iters...>& iter1, const ZipIter<T, Iters...>& iter2)
 {
+	ZIP_ITER_STAT(comparisons);
+
 	return std::get<0>(iter1.iters) < std::get<0>(iter2.iters);
 }
 
@@ -280,7 +305,7 @@ public:
 
 
     /// Also a single constructor
-    Zip (Containers... containers) : containers( containers... ) {}
+    constexpr Zip (Containers... containers) : containers( containers... ) {}
 
 
 
@@ -312,13 +337,68 @@ public:
 
 
     /// The size of the first element defines the range
-    std::size_t size () const { return std::get<0>( containers ).size(); }  
+    constexpr std::size_t size () const { return std::get<0>( containers ).size(); }
+
+
+    /// Direct access to the I-th container, so algorithms can work on a single column
+    template <std::size_t I>
+    constexpr decltype(auto) get () { return std::get<I>( containers ); }
+
+    template <std::size_t I>
+    constexpr decltype(auto) get () const { return std::get<I>( containers ); }
+
+
+
+    /** A 'Zip' of only the containers 'Is', in the given order, referring to
+      * the same containers. Iterating it moves only those iterators and builds
+      * smaller tuples, so passes reading a few columns of a wide 'Zip' pay only for them:
+      *
+      *     for(auto tup : zipped.select<0, 3>()) ...
+    */
+    template <std::size_t... Is>
+    constexpr auto select ()
+    {
+        return Zip< std::add_lvalue_reference_t< std::tuple_element_t< Is, value_type > >... >( std::get<Is>( containers )... );
+    }
+
+    template <std::size_t... Is>
+    constexpr auto select () const
+    {
+        return Zip< std::add_lvalue_reference_t< std::add_const_t< std::tuple_element_t< Is, value_type > > >... >( std::get<Is>( containers )... );
+    }
+
+
+    /// The same, selecting the columns by their element types, which must each belong to a single column
+    template <typename... Ts, std::enable_if_t< ( sizeof...(Ts) > 0 ), int > = 0>
+    constexpr auto select ()
+    {
+        return select< columnOfType<Ts>()... >();
+    }
+
+    template <typename... Ts, std::enable_if_t< ( sizeof...(Ts) > 0 ), int > = 0>
+    constexpr auto select () const
+    {
+        return select< columnOfType<Ts>()... >();
+    }
 
 
 
 private:
 
 
+    /// The index of the only container whose elements are of type T
+    template <typename T>
+    static constexpr std::size_t columnOfType ()
+    {
+        constexpr std::size_t index = help::indexOfType< T, std::decay_t< typename std::iterator_traits<
+                                          typename help::Iterable< std::remove_reference_t< Containers > >::iterator >::value_type >... >();
+
+        static_assert(index < containersSize, "The type must be the element type of exactly one container");
+
+        return index;
+    }
+
+
     /// The actual implementations
     template <std::size_t... Is>
     iterator begin (std::index_sequence<Is...>)
@@ -348,14 +428,14 @@ private:
               class Tag = iterator_category,help::EnableIfMinimumTag< Tag, std::random_access_iterator_tag > = 0 >
     auto at (std::size_t pos, std::index_sequence<Is...>)
     {
-        return std::forward_as_tuple( containers[ Is ]... );
+        return std::tuple< decltype( std::get< Is >( containers )[ pos ] )... >( std::get< Is >( containers )[ pos ]... );
     }
 
     template <std::size_t... Is,
               class Tag = iterator_category, help::EnableIfMinimumTag< Tag, std::random_access_iterator_tag > = 0 >
     auto at (std::size_t pos, std::index_sequence<Is...>) const
     {
-        return std::forward_as_tuple( containers[ Is ]... );
+        return std::tuple< decltype( std::get< Is >( containers )[ pos ] )... >( std::get< Is >( containers )[ pos ]... );
     }
 
 
@@ -369,6 +449,79 @@ private:
 
 
 
+namespace help
+{
+
+/** How 'zipIter' stores an argument. A 'ZipIter' is replaced by copies of
+  * its own iterators, anything else is kept as it was given.
+*/
+template <class T, class = std::decay_t<T>>
+struct ZipIterArg
+{
+    using types = std::tuple<T>;
+
+    static constexpr auto refs (T&& t) { return std::forward_as_tuple( std::forward<T>(t) ); }
+};
+
+template <class T, typename U, typename... Us>
+struct ZipIterArg< T, ZipIter<U, Us...> >
+{
+    using types = std::tuple< std::decay_t<U>, std::decay_t<Us>... >;
+
+    static constexpr const auto& refs (T&& t) { return t.iterators(); }
+};
+
+
+/** How 'zip' stores an argument. A 'Zip' is replaced by its containers, so
+  * nested zips give a single flat 'Zip', anything else is kept as it was
+  * given. The containers the 'Zip' refers to are still referred to. The ones
+  * it holds by value are referred to if it is an lvalue and moved otherwise.
+*/
+template <class T, class = std::decay_t<T>>
+struct ZipArg
+{
+    using types = std::tuple<T>;
+
+    static constexpr auto refs (T&& t) { return std::forward_as_tuple( std::forward<T>(t) ); }
+};
+
+template <class T, typename... Cs>
+struct ZipArg< T, Zip<Cs...> >
+{
+    template <class C>
+    using Spliced = std::conditional_t< std::is_lvalue_reference<T>::value && !std::is_reference<C>::value,
+                                        std::conditional_t< std::is_const< std::remove_reference_t<T> >::value, const C&, C& >, C >;
+
+    using types = std::tuple< Spliced<Cs>... >;
+
+    static constexpr auto refs (T&& t) { return refs(t, std::index_sequence_for<Cs...>()); }
+
+    template <std::size_t... Is>
+    static constexpr auto refs (std::remove_reference_t<T>& t, std::index_sequence<Is...>)
+    {
+        return std::forward_as_tuple( std::forward< Spliced<Cs> >( t.template get<Is>() )... );
+    }
+};
+
+
+/// Builds a 'Zip' or a 'ZipIter' with the given types from a tuple of references to their arguments
+template <template <typename...> class Class, class Types, class Refs, std::size_t... Is>
+constexpr auto makeFlat (Refs&& refs, std::index_sequence<Is...>)
+{
+    return Class< std::tuple_element_t< Is, Types >... >( std::get<Is>( std::forward<Refs>(refs) )... );
+}
+
+template <template <typename...> class Class, class Types, class Refs>
+constexpr auto makeFlat (Refs&& refs)
+{
+    return makeFlat< Class, Types >( std::forward<Refs>(refs), std::make_index_sequence< std::tuple_size<Types>::value >() );
+}
+
+} // namespace help
+
+
+
+
 /** These are the functions that will actually be called instead of
   * initializing the classes with cumbersome types. I used the first type
   * separatelly because it is easier to defined constraints (the first
@@ -378,14 +531,25 @@ private:
 template <typename T, typename... Iterators>
 auto zipIter (T&& t, Iterators&&... iterators)
 {
-    return ZipIter<T, Iterators...>(std::forward<T>(t), std::forward<Iterators>(iterators)...);
+    using Types = decltype( std::tuple_cat( std::declval< typename help::ZipIterArg<T>::types >(),
+                                            std::declval< typename help::ZipIterArg<Iterators>::types >()... ) );
+
+    return help::makeFlat< ZipIter, Types >( std::tuple_cat( help::ZipIterArg<T>::refs( std::forward<T>(t) ),
+                                                             help::ZipIterArg<Iterators>::refs( std::forward<Iterators>(iterators) )... ) );
 }
 
 
+/** Zips and 'Zip's given as arguments are flattened: 'zip(zip(a, b), c)' is
+  * the same as 'zip(a, b, c)', with a single iterator per container and flat tuples.
+*/
 template <typename T, typename... Containers, std::enable_if_t< !std::is_pointer< T >::value, int > = 0>
-auto zip (T&& t, Containers&&... containers)
+constexpr auto zip (T&& t, Containers&&... containers)
 {
-    return Zip<T, Containers...>(std::forward<T>(t), std::forward<Containers>(containers)...);
+    using Types = decltype( std::tuple_cat( std::declval< typename help::ZipArg<T>::types >(),
+                                            std::declval< typename help::ZipArg<Containers>::types >()... ) );
+
+    return help::makeFlat< Zip, Types >( std::tuple_cat( help::ZipArg<T>::refs( std::forward<T>(t) ),
+                                                         help::ZipArg<Containers>::refs( std::forward<Containers>(containers) )... ) );
 }
 
 
@@ -471,13 +635,13 @@ auto unZip (F f)
 }
 
 template <class Tuple, class Function, std::size_t... Is>
-decltype(auto) unZip (Tuple&& tup, Function function, std::index_sequence<Is...>)
+constexpr decltype(auto) unZip (Tuple&& tup, Function function, std::index_sequence<Is...>)
 {
     return function( std::get< Is >( std::forward<Tuple>(tup) )... );
 }
 
 template <class Tuple, class Function>
-decltype(auto) unZip (Tuple&& tup, Function function)
+constexpr decltype(auto) unZip (Tuple&& tup, Function function)
 {
     return unZip(std::forward<Tuple>(tup), function, std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value>());
 }
@@ -504,6 +668,52 @@ void forEach (Args&&... args)
 }
 
 
+
+
+/// Some helpers for the algorithms that work on random access zipped ranges, one row or one column at a time
+namespace help
+{
+
+/// Tuple of references to the elements of a single row
+template <class ZipT, std::size_t... Is>
+auto rowAt (const ZipT& zipped, std::size_t row, std::index_sequence<Is...>)
+{
+    return std::tuple< decltype( help::begin( zipped.template get<Is>() )[row] )... >( help::begin( zipped.template get<Is>() )[row]... );
+}
+
+
+/// The value type of the I-th column of a 'Zip'
+template <class ZipT, std::size_t I>
+using ColumnType = std::decay_t< std::tuple_element_t< I, typename ZipT::iterator::value_type > >;
+
+
+/// Copies the given rows of the I-th column into a std::vector
+template <std::size_t I, class ZipT>
+auto gatherColumn (const ZipT& zipped, const std::vector<std::size_t>& rows)
+{
+    std::vector< std::tuple_element_t< I, typename ZipT::iterator::value_type > > res;
+
+    res.reserve(rows.size());
+
+    auto first = help::begin( zipped.template get<I>() );
+
+    for(auto row : rows)
+        res.push_back(first[row]);
+
+    return res;
+}
+
+
+/// Copies the given rows of the selected columns into a tuple of std::vector's
+template <class ZipT, std::size_t... Is>
+auto gatherRows (const ZipT& zipped, const std::vector<std::size_t>& rows, std::index_sequence<Is...>)
+{
+    return std::make_tuple( gatherColumn<Is>(zipped, rows)... );
+}
+
+} // namespace help
+
+
 } // namespace it
 
 
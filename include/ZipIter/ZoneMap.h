@@ -0,0 +1,190 @@
+/**
+ *  @file    ZoneMap.h
+ *
+ *  @brief Per block minimum and maximum of a column, used to skip whole
+ *         blocks of a zipped range in scans with a range predicate. It
+ *         works best on sorted or clustered columns, like timestamps.
+ */
+
+
+
+#ifndef ZONE_MAP_ZIP_ITER_H
+#define ZONE_MAP_ZIP_ITER_H
+
+#include <vector>
+#include <algorithm>
+
+#include "ZipIter.h"
+
+
+
+namespace it
+{
+
+/** \class ZoneMap
+  *
+  * Keeps the minimum and maximum of each block of 'blockRows' rows of a
+  * column. It is built once and then updated as rows are appended to the
+  * column, touching only the last block and the new ones. Only 'operator<'
+  * of the values is used.
+*/
+template <typename T>
+class ZoneMap
+{
+public:
+
+    using value_type = T;
+
+
+    ZoneMap (std::size_t blockRows = 4096) : rowsPerBlock(std::max(blockRows, std::size_t(1))) {}
+
+    template <class Container>
+    ZoneMap (const Container& column, std::size_t blockRows = 4096) : ZoneMap(blockRows)
+    {
+        update(column);
+    }
+
+
+
+    /// Adds the values in [first, last) as new rows at the end
+    template <class Iter>
+    void append (Iter first, Iter last)
+    {
+        for(; first != last; ++first, ++rows)
+        {
+            const T& value = *first;
+
+            if(rows % rowsPerBlock == 0)
+            {
+                mins.push_back(value);
+                maxs.push_back(value);
+            }
+
+            else
+            {
+                if(value < mins.back()) mins.back() = value;
+                if(maxs.back() < value) maxs.back() = value;
+            }
+        }
+    }
+
+
+    /// Adds the rows of 'column' after the ones already in the map, after 'column' has grown
+    template <class Container>
+    void update (const Container& column)
+    {
+        append(help::begin(column) + rows, help::end(column));
+    }
+
+
+
+    /** Calls 'f(firstRow, lastRow, all)' for each maximal range of consecutive
+      * blocks that may have values in [lo, hi], and returns the number of rows
+      * in those ranges. 'all' is true if every value of the range is known to
+      * be in [lo, hi], so the rows do not need to be checked one by one.
+    */
+    template <class F>
+    std::size_t forEachCandidate (const T& lo, const T& hi, F f) const
+    {
+        std::size_t count = 0;
+
+        for(std::size_t b = 0; b < blocks(); )
+        {
+            if(maxs[b] < lo || hi < mins[b])
+            {
+                ++b;
+                continue;
+            }
+
+            bool all = !(mins[b] < lo) && !(hi < maxs[b]);
+
+            std::size_t e = b + 1;
+
+            while(e < blocks() && !(maxs[e] < lo || hi < mins[e]) && all == (!(mins[e] < lo) && !(hi < maxs[e])))
+                ++e;
+
+            std::size_t first = b * rowsPerBlock, last = std::min(e * rowsPerBlock, rows);
+
+            f(first, last, all);
+
+            count += last - first;
+
+            b = e;
+        }
+
+        return count;
+    }
+
+
+
+    std::size_t size () const { return rows; }
+
+    std::size_t blocks () const { return mins.size(); }
+
+    std::size_t blockRows () const { return rowsPerBlock; }
+
+    const T& min (std::size_t block) const { return mins[block]; }
+
+    const T& max (std::size_t block) const { return maxs[block]; }
+
+
+
+private:
+
+    std::size_t rowsPerBlock;
+
+    std::size_t rows = 0;
+
+    std::vector<T> mins, maxs;
+};
+
+
+
+/// Builds a 'ZoneMap' over the I-th column of 'zipped'
+template <std::size_t I = 0, typename... Containers>
+auto makeZoneMap (const Zip<Containers...>& zipped, std::size_t blockRows = 4096)
+{
+    return ZoneMap< help::ColumnType< Zip<Containers...>, I > >(zipped.template get<I>(), blockRows);
+}
+
+
+
+
+/** Calls 'f' with the elements of each row of 'zipped' (as in 'unZip')
+  * whose value in the I-th column is in [lo, hi], in order. 'zones' must be
+  * up to date with that column. Blocks that can not match are skipped in every
+  * column, and the rows of blocks that are entirely in the range are not checked.
+  * Returns the number of rows passed to 'f'. The containers must be random access.
+*/
+template <std::size_t I = 0, typename... Containers, typename T, class F>
+std::size_t scanRange (const Zip<Containers...>& zipped, const ZoneMap<T>& zones,
+                       const typename ZoneMap<T>::value_type& lo, const typename ZoneMap<T>::value_type& hi, F f)
+{
+    auto keys = help::begin(zipped.template get<I>());
+
+    auto is = std::make_index_sequence<sizeof...(Containers)>();
+
+    std::size_t count = 0;
+
+    zones.forEachCandidate(lo, hi, [&](std::size_t first, std::size_t last, bool all)
+    {
+        for(std::size_t i = first; i < last; ++i)
+        {
+            if(!all && (keys[i] < lo || hi < keys[i]))
+                continue;
+
+            unZip(help::rowAt(zipped, i, is), f);
+
+            ++count;
+        }
+    });
+
+    return count;
+}
+
+
+} // namespace it
+
+
+
+#endif // ZONE_MAP_ZIP_ITER_H
@@ -0,0 +1,106 @@
+#include <vector>
+#include <string>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Adjacent.h"
+
+
+namespace
+{
+	struct AdjacentTest : public ::testing::Test
+	{
+		AdjacentTest () {}
+
+		virtual ~AdjacentTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				x.push_back(std::uniform_real_distribution<>(0.0, 1.0)(gen));
+				y.push_back(i * i);
+				s.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 1000;
+
+		std::vector<double> x;
+		std::vector<int> y;
+		std::vector<std::string> s;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(AdjacentTest, RowMajor)
+	{
+		int i = 0;
+
+		for(auto tup : it::adjacent<2>(it::zip(x, y, s)))
+		{
+			it::unZip(tup, [&](double x0, int y0, const std::string& s0, double x1, int y1, const std::string& s1)
+			{
+				EXPECT_EQ(x0, x[i]);
+				EXPECT_EQ(x1, x[i+1]);
+				EXPECT_EQ(y1 - y0, 2 * i + 1);
+				EXPECT_EQ(s0, s[i]);
+				EXPECT_EQ(s1, s[i+1]);
+			});
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n - 1);
+		EXPECT_EQ(it::adjacent<2>(it::zip(x, y, s)).size(), std::size_t(n - 1));
+	}
+
+
+	TEST_F(AdjacentTest, ColumnMajor)
+	{
+		std::vector<double> smooth;
+
+		for(auto tup : it::window<3>(it::zip(x, y)))
+			it::unZip(tup, [&](double x0, double x1, double x2, int y0, int y1, int y2)
+			{
+				smooth.push_back((x0 + x1 + x2) / 3);
+
+				EXPECT_EQ(y0 - 2 * y1 + y2, 2);
+			});
+
+		ASSERT_EQ(smooth.size(), std::size_t(n - 2));
+
+		for(int i = 0; i < n - 2; ++i)
+			EXPECT_DOUBLE_EQ(smooth[i], (x[i] + x[i+1] + x[i+2]) / 3);
+	}
+
+
+	TEST_F(AdjacentTest, Sizes)
+	{
+		std::vector<int> v = { 1, 2, 3 };
+
+		EXPECT_EQ(it::adjacent<4>(it::zip(v)).size(), 0u);
+		EXPECT_TRUE(it::adjacent<4>(it::zip(v)).begin() == it::adjacent<4>(it::zip(v)).end());
+
+		int count = 0;
+
+		for(auto tup : it::window<3>(it::zip(v)))
+		{
+			EXPECT_EQ(tup, std::make_tuple(1, 2, 3));
+			++count;
+		}
+
+		EXPECT_EQ(count, 1);
+
+		auto windows = it::adjacent<1>(it::zip(v));
+
+		EXPECT_EQ(std::distance(windows.begin(), windows.end()), 3);
+	}
+}
@@ -0,0 +1,165 @@
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "ZipIter/AsyncColumns.h"
+
+
+namespace
+{
+	struct AsyncColumnsTest : public ::testing::Test
+	{
+		AsyncColumnsTest () {}
+
+		virtual ~AsyncColumnsTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				prices.push_back(std::uniform_real_distribution<>(0.0, 100.0)(gen));
+				qtys.push_back(std::uniform_int_distribution<>(1, 1000)(gen));
+			}
+
+			write(pricePath, prices);
+			write(qtyPath, qtys);
+		}
+
+		virtual void TearDown ()
+		{
+			std::remove(pricePath.c_str());
+			std::remove(qtyPath.c_str());
+		}
+
+
+		template <typename T>
+		static void write (const std::string& path, const std::vector<T>& column)
+		{
+			std::FILE* file = std::fopen(path.c_str(), "wb");
+
+			ASSERT_TRUE(file);
+			ASSERT_EQ(std::fwrite(column.data(), sizeof(T), column.size(), file), column.size());
+
+			std::fclose(file);
+		}
+
+
+		int n = 100003;
+
+		std::vector<double> prices;
+		std::vector<int> qtys;
+
+		std::string pricePath = ::testing::TempDir() + "AsyncColumnsTest_price.bin";
+		std::string qtyPath = ::testing::TempDir() + "AsyncColumnsTest_qty.bin";
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(AsyncColumnsTest, Batches)
+	{
+		for(std::size_t depth : { 1, 2, 3 })
+		{
+			it::AsyncOptions options;
+
+			options.batchRows = 4096;
+			options.depth = depth;
+			options.ioThreads = 2;
+
+			std::size_t row = 0, batches = 0;
+
+			std::size_t rows = it::asyncColumns<double, int>(options, pricePath, qtyPath).forEachBatch([&](auto batch)
+			{
+				EXPECT_LE(batch.size(), options.batchRows);
+
+				it::forEach(batch, [&](double price, int qty)
+				{
+					EXPECT_EQ(price, prices[row]);
+					EXPECT_EQ(qty, qtys[row]);
+
+					row++;
+				});
+
+				batches++;
+			});
+
+			EXPECT_EQ(rows, std::size_t(n));
+			EXPECT_EQ(row, std::size_t(n));
+			EXPECT_EQ(batches, (n + options.batchRows - 1) / options.batchRows);
+		}
+	}
+
+
+	TEST_F(AsyncColumnsTest, Sizes)
+	{
+		std::vector<int> shorter(qtys.begin(), qtys.begin() + 10);
+
+		write(qtyPath, shorter);
+
+		double sum = 0.0;
+
+		std::size_t rows = it::asyncColumns<double, int>(pricePath, qtyPath).forEachBatch([&](auto batch)
+		{
+			it::forEach(batch, [&](double price, int qty){ sum += price * qty; });
+		});
+
+		EXPECT_EQ(rows, 10u);
+
+		double expected = 0.0;
+
+		for(int i = 0; i < 10; ++i)
+			expected += prices[i] * shorter[i];
+
+		EXPECT_DOUBLE_EQ(sum, expected);
+
+		EXPECT_THROW(it::asyncColumns<int>(::testing::TempDir() + "AsyncColumnsTest_missing.bin").forEachBatch([](auto){}), std::runtime_error);
+	}
+
+
+#if defined(ZIP_ITER_COROUTINES)
+
+	TEST_F(AsyncColumnsTest, Coroutine)
+	{
+		it::AsyncOptions options;
+
+		options.batchRows = 1000;
+
+		auto columns = it::asyncColumns<double, int>(options, pricePath, qtyPath);
+
+		std::size_t row = 0;
+
+		for(auto& batch : columns.batches())
+			for(auto tup : batch)
+			{
+				EXPECT_EQ(std::get<0>(tup), prices[row]);
+				EXPECT_EQ(std::get<1>(tup), qtys[row]);
+
+				row++;
+			}
+
+		EXPECT_EQ(row, std::size_t(n));
+
+
+		/// The generator must not refer to the temporary 'AsyncColumns' it came from
+		row = 0;
+
+		for(auto& batch : it::asyncColumns<double, int>(options, pricePath, qtyPath).batches())
+			it::forEach(batch, [&](double price, int qty)
+			{
+				EXPECT_EQ(price, prices[row]);
+				EXPECT_EQ(qty, qtys[row]);
+
+				row++;
+			});
+
+		EXPECT_EQ(row, std::size_t(n));
+	}
+
+#endif
+}
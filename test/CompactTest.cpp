@@ -0,0 +1,139 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Compact.h"
+
+
+namespace
+{
+	struct CompactTest : public ::testing::Test
+	{
+		CompactTest () {}
+
+		virtual ~CompactTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(0, 5)(gen));
+				b.push_back(0.5 * i);
+				c.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 500;
+
+		std::vector<int> a;
+		std::vector<double> b;
+		std::vector<std::string> c;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(CompactTest, RemoveIf)
+	{
+		auto auxA = a;
+		auto auxB = b;
+		auto auxC = c;
+
+		auto pred = [](int x, double y, const std::string&){ return x == 2 || y > 200.0; };
+
+		auto end = std::remove_if(ZIP_ALL(auxA, auxB, auxC), it::unZip(pred));
+
+		std::size_t size = it::compact(it::zip(a, b, c), pred);
+
+		ASSERT_EQ(size, std::size_t(end - it::zipBegin(auxA, auxB, auxC)));
+
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			EXPECT_EQ(a[i], auxA[i]);
+			EXPECT_EQ(b[i], auxB[i]);
+			EXPECT_EQ(c[i], auxC[i]);
+		}
+	}
+
+
+	TEST_F(CompactTest, NothingRemoved)
+	{
+		auto auxB = b;
+
+		EXPECT_EQ(it::compact(it::zip(a, b, c), [](int, double, const std::string&){ return false; }), std::size_t(n));
+		EXPECT_EQ(b, auxB);
+
+		EXPECT_EQ(it::compact(it::zip(a, b, c), [](int, double, const std::string&){ return true; }), 0);
+	}
+
+
+	TEST_F(CompactTest, MoveOnly)
+	{
+		std::vector<std::unique_ptr<int>> ptrs;
+
+		for(int x : a)
+			ptrs.emplace_back(new int(x));
+
+		std::size_t kept = std::count_if(a.begin(), a.end(), [](int x){ return x % 3 != 0; });
+
+		std::size_t size = it::compact(it::zip(a, ptrs), [](int x, const std::unique_ptr<int>&){ return x % 3 == 0; });
+
+		ASSERT_EQ(size, kept);
+
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			ASSERT_TRUE(ptrs[i]);
+			EXPECT_EQ(*ptrs[i], a[i]);
+			EXPECT_NE(a[i] % 3, 0);
+		}
+	}
+
+
+	TEST_F(CompactTest, Unique)
+	{
+		std::sort(ZIP_ALL(a, b, c), it::unZip([](int x1, double, const std::string&, int x2, double, const std::string&){ return x1 < x2; }));
+
+		std::vector<std::string> firsts;
+
+		for(int i = 0; i < n; ++i)
+			if(i == 0 || a[i] != a[i-1])
+				firsts.push_back(c[i]);
+
+		std::size_t size = it::unique(it::zip(a, b, c), [](int x1, double, const std::string&, int x2, double, const std::string&){ return x1 == x2; });
+
+		ASSERT_EQ(size, firsts.size());
+
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			EXPECT_EQ(c[i], firsts[i]);
+			EXPECT_EQ(b[i], 0.5 * std::stoi(c[i]));
+
+			EXPECT_TRUE(i == 0 || a[i-1] < a[i]);
+		}
+	}
+
+
+	TEST_F(CompactTest, UniqueAllColumns)
+	{
+		std::vector<int> x = { 1, 1, 1, 2, 2, 3 };
+		std::vector<int> y = { 1, 1, 2, 2, 2, 3 };
+
+		std::size_t size = it::unique(it::zip(x, y));
+
+		ASSERT_EQ(size, 4);
+
+		EXPECT_EQ(std::vector<int>(x.begin(), x.begin() + size), std::vector<int>({ 1, 1, 2, 3 }));
+		EXPECT_EQ(std::vector<int>(y.begin(), y.begin() + size), std::vector<int>({ 1, 2, 2, 3 }));
+	}
+
+
+} // namespace
@@ -0,0 +1,162 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Delimited.h"
+
+
+namespace
+{
+	struct DelimitedTest : public ::testing::Test
+	{
+		DelimitedTest () {}
+
+		virtual ~DelimitedTest () { }
+
+		virtual void SetUp ()
+		{
+			std::ostringstream out;
+
+			out << "id,value,name,extra\n";
+
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(-100000, 100000)(gen));
+				b.push_back(0.5 * i);
+				c.push_back("name" + std::to_string(i));
+
+				out << a.back() << "," << b.back() << "," << c.back() << ",x" << (i % 3 ? "\n" : "\r\n");
+			}
+
+			text = out.str();
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 20000;
+
+		std::vector<int> a;
+		std::vector<double> b;
+		std::vector<std::string> c;
+
+		std::string text;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(DelimitedTest, Columns)
+	{
+		for(std::size_t threads : { 1, 2, 7 })
+		{
+			it::DelimitedOptions options;
+
+			options.header = true;
+			options.numThreads = threads;
+
+			auto res = it::parseDelimited<int, double, std::string>(text.data(), text.size(), options);
+
+			EXPECT_EQ(std::get<0>(res), a);
+			EXPECT_EQ(std::get<1>(res), b);
+			EXPECT_EQ(std::get<2>(res), c);
+		}
+	}
+
+
+	TEST_F(DelimitedTest, Append)
+	{
+		std::vector<long long> x = { 7 };
+		std::vector<float> y = { 1.0f };
+
+		std::string input = "1|2.5\n\n-3|4e2\n5|0";
+
+		it::DelimitedOptions options;
+
+		options.delimiter = '|';
+
+		EXPECT_EQ(it::parseDelimited(input.data(), input.size(), options, x, y), 3u);
+
+		EXPECT_EQ(x, std::vector<long long>({ 7, 1, -3, 5 }));
+		EXPECT_EQ(y, std::vector<float>({ 1.0f, 2.5f, 400.0f, 0.0f }));
+	}
+
+
+	TEST_F(DelimitedTest, File)
+	{
+		std::string path = ::testing::TempDir() + "/zipiter-delimited.csv";
+
+		std::ofstream(path, std::ios::binary) << text;
+
+		it::DelimitedOptions options;
+
+		options.header = true;
+		options.numThreads = 4;
+
+		std::vector<int> x;
+		std::vector<double> y;
+
+		EXPECT_EQ(it::parseDelimitedFile(path, options, x, y), std::size_t(n));
+
+		EXPECT_EQ(x, a);
+		EXPECT_EQ(y, b);
+
+		std::remove(path.c_str());
+
+		EXPECT_THROW(it::parseDelimitedFile<int>(path), std::runtime_error);
+	}
+
+
+	TEST_F(DelimitedTest, Errors)
+	{
+		for(std::string input : { "1,2\n3", "1,x\n", "99999999999,1\n", "1,-1\n", "1,2\n,3\n" })
+		{
+			std::vector<int> x;
+			std::vector<unsigned> y;
+
+			EXPECT_THROW(it::parseDelimited(input.data(), input.size(), it::DelimitedOptions(), x, y), std::runtime_error) << input;
+		}
+
+		/// The error gives the line of the input, counting the header and the empty lines, and the columns are left as they were
+		{
+			std::vector<int> x = { 7 }, y = { 8 };
+
+			std::string input = "x,y\n1,2\n\n3,4\n\n5,z\n";
+
+			it::DelimitedOptions options;
+
+			options.header = true;
+
+			try
+			{
+				it::parseDelimited(input.data(), input.size(), options, x, y);
+
+				ADD_FAILURE() << "No exception thrown";
+			}
+
+			catch(const std::runtime_error& error)
+			{
+				EXPECT_NE(std::string(error.what()).find("line 6:"), std::string::npos) << error.what();
+			}
+
+			EXPECT_EQ(x, std::vector<int>({ 7 }));
+			EXPECT_EQ(y, std::vector<int>({ 8 }));
+		}
+
+		std::vector<unsigned char> x;
+		std::vector<std::string> y;
+
+		std::string input = "255,\n0,a";
+
+		EXPECT_EQ(it::parseDelimited(input.data(), input.size(), it::DelimitedOptions(), x, y), 2u);
+		EXPECT_EQ(x, std::vector<unsigned char>({ 255, 0 }));
+		EXPECT_EQ(y, std::vector<std::string>({ "", "a" }));
+	}
+}
@@ -0,0 +1,170 @@
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "ZipIter/DictColumn.h"
+#include "ZipIter/GroupBy.h"
+
+
+namespace
+{
+	struct DictColumnTest : public ::testing::Test
+	{
+		DictColumnTest () {}
+
+		virtual ~DictColumnTest () { }
+
+		virtual void SetUp ()
+		{
+			const std::vector<std::string> venues = { "XNYS", "XNAS", "BATS", "ARCX", "IEXG", "EDGX" };
+
+			for(int i = 0; i < n; ++i)
+			{
+				names.push_back(venues[std::uniform_int_distribution<>(0, int(venues.size()) - 1)(gen)]);
+				values.push_back(i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 5000;
+
+		std::vector<std::string> names;
+		std::vector<int> values;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(DictColumnTest, Zip)
+	{
+		auto column = it::makeDictColumn(names);
+
+		ASSERT_EQ(column.size(), names.size());
+		EXPECT_EQ(column.cardinality(), 6u);
+		EXPECT_TRUE(column.sorted());
+		EXPECT_TRUE(std::is_sorted(column.dictionary().begin(), column.dictionary().end()));
+
+		int i = 0;
+
+		for(auto tup : it::zip(column, values))
+		{
+			it::unZip(tup, [&](const std::string& name, int value)
+			{
+				EXPECT_EQ(name, names[i]);
+				EXPECT_EQ(value, i);
+			});
+
+			EXPECT_EQ(column.decode(column.codes()[i]), names[i]);
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n);
+		EXPECT_TRUE(std::equal(column.begin(), column.end(), names.begin()));
+	}
+
+
+	TEST_F(DictColumnTest, Codes)
+	{
+		auto column = it::makeDictColumn(names);
+
+		/// Equality filter on the codes
+		std::size_t code = column.find("BATS");
+
+		ASSERT_NE(code, column.npos);
+		EXPECT_EQ(column.find("XLON"), column.npos);
+
+		EXPECT_EQ(std::count(column.codes().begin(), column.codes().end(), code), std::count(names.begin(), names.end(), "BATS"));
+
+
+		/// Group by on the codes
+		auto res = it::groupBy(it::zip(column.codes(), values), it::agg::sum<1>(), it::agg::count());
+
+		std::map<std::string, long long> sums;
+
+		for(int k = 0; k < n; ++k)
+			sums[names[k]] += values[k];
+
+		ASSERT_EQ(std::get<0>(res).size(), sums.size());
+
+		for(std::size_t g = 0; g < std::get<0>(res).size(); ++g)
+			EXPECT_EQ(std::get<1>(res)[g], sums[column.decode(std::get<0>(res)[g])]);
+
+
+		/// Sorting the codes sorts by value, since the dictionary is sorted
+		auto auxN = names;
+		auto auxV = values;
+
+		std::stable_sort(ZIP_ALL(auxN, auxV), [](const auto& x, const auto& y){ return std::get<0>(x) < std::get<0>(y); });
+
+		it::ScratchArena arena;
+
+		it::sort(it::zip(column.codes(), values), arena);
+
+		EXPECT_EQ(values, auxV);
+		EXPECT_TRUE(std::equal(column.begin(), column.end(), auxN.begin()));
+
+		std::shuffle(ZIP_ALL(column.codes(), values), gen);
+
+		it::sort(it::zip(column, values), arena);
+
+		EXPECT_TRUE(std::equal(column.begin(), column.end(), auxN.begin()));
+	}
+
+
+	TEST_F(DictColumnTest, Dictionary)
+	{
+		it::DictColumn<int> column = { 30, 10, 30, 20 };
+
+		EXPECT_FALSE(column.sorted());
+		EXPECT_EQ(column.codes(), std::vector<std::uint8_t>({ 0, 1, 0, 2 }));
+
+		column.sortDictionary();
+
+		EXPECT_EQ(column.codes(), std::vector<std::uint8_t>({ 2, 0, 2, 1 }));
+		EXPECT_EQ(column.dictionary(), std::vector<int>({ 10, 20, 30 }));
+		EXPECT_EQ(column[0], 30);
+
+		for(int k = 0; k < 253; ++k)
+			column.push_back(100 + k);
+
+		EXPECT_EQ(column.cardinality(), 256u);
+		EXPECT_THROW(column.push_back(-1), std::runtime_error);
+
+		/// The failed push leaves the column as it was, so it fails again
+		EXPECT_THROW(column.push_back(-1), std::runtime_error);
+		EXPECT_EQ(column.cardinality(), 256u);
+		EXPECT_EQ(column.size(), 257u);
+		EXPECT_EQ(column.find(-1), column.npos);
+
+		column.push_back(30);
+		EXPECT_EQ(column[257], 30);
+
+		it::DictColumn<int, std::uint16_t> wide;
+
+		for(int k = 0; k < 1000; ++k)
+			wide.push_back(k % 700);
+
+		EXPECT_EQ(wide.cardinality(), 700u);
+		EXPECT_EQ(wide[999], 299);
+
+		/// Codes as wide as std::size_t must not wrap the limit of distinct values
+		it::DictColumn<int, std::uint64_t> widest;
+
+		widest.push_back(5);
+		widest.push_back(7);
+
+		EXPECT_EQ(widest.cardinality(), 2u);
+		EXPECT_EQ(widest[1], 7);
+		EXPECT_GT(widest.maxValues, 2u);
+	}
+}
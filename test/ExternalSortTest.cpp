@@ -0,0 +1,121 @@
+#include <vector>
+#include <string>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <dirent.h>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ExternalSort.h"
+
+
+namespace
+{
+	struct ExternalSortTest : public ::testing::Test
+	{
+		ExternalSortTest () {}
+
+		virtual ~ExternalSortTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(0, 100)(gen));
+				b.push_back(i);
+				c.push_back(0.5f * i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// Number of run files left in the temporary directory
+		int leftovers ()
+		{
+			int count = 0;
+
+			if(DIR* dir = opendir(tmpdir.c_str()))
+			{
+				while(dirent* entry = readdir(dir))
+					count += std::string(entry->d_name).find("zipiter-run-") == 0;
+
+				closedir(dir);
+			}
+
+			return count;
+		}
+
+
+		template <class Compare>
+		void check (std::size_t memBudget, Compare compare)
+		{
+			auto auxA = a;
+			auto auxB = b;
+			auto auxC = c;
+
+			std::stable_sort(ZIP_ALL(auxA, auxB, auxC), [&](const auto& x, const auto& y){
+				return compare(std::get<0>(x), std::get<0>(y));
+			});
+
+			std::vector<int> outA(n);
+			std::vector<long long> outB(n);
+			std::vector<float> outC(n);
+
+			auto end = it::externalSort(it::zip(a, b, c), tmpdir, memBudget, it::zipBegin(outA, outB, outC), compare);
+
+			EXPECT_TRUE(end == it::zipEnd(outA, outB, outC));
+
+			EXPECT_EQ(outA, auxA);
+			EXPECT_EQ(outB, auxB);
+			EXPECT_EQ(outC, auxC);
+
+			EXPECT_EQ(leftovers(), 0);
+		}
+
+
+		int n = 10000;
+
+		std::string tmpdir = ::testing::TempDir();
+
+		std::vector<int> a;
+		std::vector<long long> b;
+		std::vector<float> c;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(ExternalSortTest, ManyRuns)
+	{
+		check(100 * 16, std::less<>());
+		check(7 * 16, std::greater<>());
+	}
+
+
+	TEST_F(ExternalSortTest, SingleRun)
+	{
+		check(n * 16, std::less<>());
+		check(n * 16 - 1, std::less<>());
+	}
+
+
+	TEST_F(ExternalSortTest, TupleOutput)
+	{
+		std::vector<std::tuple<int, long long, float>> out;
+
+		it::externalSort(it::zip(a, b, c), tmpdir, 1000, std::back_inserter(out));
+
+		ASSERT_EQ(out.size(), a.size());
+
+		/// The second column is the original row, so a stable sort gives lexicographically sorted tuples
+		EXPECT_TRUE(std::is_sorted(out.begin(), out.end()));
+
+		EXPECT_EQ(leftovers(), 0);
+	}
+}
@@ -0,0 +1,121 @@
+#include <array>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Fixed.h"
+
+
+namespace
+{
+	/// Function objects with a constexpr call operator, as C++14 lambdas can not be used at compile time
+	struct Dot
+	{
+		template <typename T>
+		constexpr void operator () (T x, T y) { sum += x * y; }
+
+		double sum = 0.0;
+	};
+
+	struct Square
+	{
+		constexpr int operator () (int x) const { return x * x; }
+	};
+
+	struct Axpy
+	{
+		constexpr void operator () (int& y, int x) const { y += a * x; }
+
+		int a;
+	};
+
+
+	constexpr std::array<int, 4> axpy (std::array<int, 4> y, const std::array<int, 4>& x, int a)
+	{
+		it::forEachFixed(y, x, Axpy{ a });
+
+		return y;
+	}
+
+
+	constexpr std::array<double, 3> u = {{ 1.0, 2.0, 3.0 }};
+	constexpr std::array<double, 3> v = {{ 4.0, 5.0, 6.0 }};
+
+	static_assert(it::forEachFixed(u, v, Dot{}).sum == 32.0, "Dot product at compile time");
+
+	constexpr std::array<int, 5> base = {{ 0, 1, 2, 3, 4 }};
+	constexpr auto squares = it::transformFixed(base, Square{});
+
+	static_assert(squares[4] == 16 && squares.size() == 5, "Table at compile time");
+
+	static_assert(std::get<2>(axpy({{ 1, 1, 1, 1 }}, {{ 1, 2, 3, 4 }}, 10)) == 31, "Modifying an array at compile time");
+
+	static_assert(it::zip(u, v).size() == 3, "Size of a zip at compile time");
+
+
+
+
+	struct FixedTest : public ::testing::Test
+	{
+		FixedTest () {}
+
+		virtual ~FixedTest () { }
+
+		virtual void SetUp () {}
+
+		virtual void TearDown () {}
+	};
+
+
+
+
+
+	TEST_F(FixedTest, ForEach)
+	{
+		std::array<double, 16> a;
+		double b[16];
+		const std::array<int, 16> c = {{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }};
+
+		for(int i = 0; i < 16; ++i)
+			a[i] = b[i] = 0.5 * i;
+
+		int calls = 0;
+
+		it::forEachFixed(a, b, c, [&](double& x, double y, int z)
+		{
+			x += y * z;
+			calls++;
+		});
+
+		EXPECT_EQ(calls, 16);
+
+		for(int i = 0; i < 16; ++i)
+			EXPECT_EQ(a[i], 0.5 * i + 0.5 * i * (i + 1));
+
+		auto dot = it::forEachFixed(a, b, Dot{});
+
+		double expected = 0.0;
+
+		for(int i = 0; i < 16; ++i)
+			expected += a[i] * b[i];
+
+		EXPECT_DOUBLE_EQ(dot.sum, expected);
+	}
+
+
+	TEST_F(FixedTest, Transform)
+	{
+		std::array<int, 3> x = {{ 1, 2, 3 }};
+		int y[3] = { 10, 20, 30 };
+
+		auto sums = it::transformFixed(x, y, [](int p, int q){ return p + q; });
+
+		EXPECT_EQ(sums, (std::array<int, 3>{{ 11, 22, 33 }}));
+		EXPECT_EQ(squares, (std::array<int, 5>{{ 0, 1, 4, 9, 16 }}));
+
+		std::vector<int> names;
+
+		it::forEachFixed(x, [&](int p){ names.push_back(p); });
+
+		EXPECT_EQ(names, std::vector<int>({ 1, 2, 3 }));
+	}
+}
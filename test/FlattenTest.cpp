@@ -0,0 +1,126 @@
+#include <vector>
+#include <list>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ZipIter.h"
+
+
+namespace
+{
+	struct FlattenTest : public ::testing::Test
+	{
+		FlattenTest () {}
+
+		virtual ~FlattenTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(n - i);
+				b.push_back(0.5 * i);
+				c.push_back(std::to_string(i));
+				d.push_back(i % 7);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 500;
+
+		std::vector<int> a;
+		std::vector<double> b;
+		std::vector<std::string> c;
+		std::vector<int> d;
+	};
+
+
+
+
+
+	TEST_F(FlattenTest, Zip)
+	{
+		auto nested = it::zip(it::zip(a, b), c);
+
+		static_assert(std::is_same< decltype(nested), it::Zip< std::vector<int>&, std::vector<double>&, std::vector<std::string>& > >::value,
+		              "A nested zip is flat");
+
+		auto deep = it::zip(it::zip(it::zip(a), b), it::zip(c, d));
+
+		static_assert(decltype(deep)::containersSize == 4, "Any depth is flattened");
+
+		int i = 0;
+
+		for(auto tup : deep)
+		{
+			static_assert(std::tuple_size<decltype(tup)>::value == 4, "The tuples are flat");
+
+			it::unZip(tup, [&](int x, double y, const std::string& s, int& z)
+			{
+				EXPECT_EQ(x, n - i);
+				EXPECT_EQ(y, 0.5 * i);
+				EXPECT_EQ(s, c[i]);
+
+				z = -z;
+			});
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n);
+		EXPECT_EQ(d[3], -3);
+
+		std::sort(nested.begin(), nested.end());
+
+		EXPECT_TRUE(std::is_sorted(a.begin(), a.end()));
+		EXPECT_EQ(b[0], 0.5 * (n - 1));
+	}
+
+
+	TEST_F(FlattenTest, Ownership)
+	{
+		/// A zip holding a container by value gives it to the outer zip when it is a temporary
+		auto moved = it::zip(it::zip(std::vector<int>{ 1, 2, 3 }), a);
+
+		static_assert(std::is_same< decltype(moved), it::Zip< std::vector<int>, std::vector<int>& > >::value, "Moved in");
+
+		EXPECT_EQ(std::get<0>(moved[2]), 3);
+
+		/// And refers to it when it is an lvalue
+		auto inner = it::zip(std::vector<int>{ 4, 5, 6 }, b);
+		auto referred = it::zip(inner, c);
+
+		static_assert(std::is_same< decltype(referred), it::Zip< std::vector<int>&, std::vector<double>&, std::vector<std::string>& > >::value,
+		              "Referred");
+
+		std::get<0>(referred[0]) = 40;
+
+		EXPECT_EQ(std::get<0>(inner[0]), 40);
+
+		int sum = 0;
+
+		it::forEach(it::zip(a, d), b, [&](int x, int y, double){ sum += x + y; });
+
+		EXPECT_EQ(sum, std::accumulate(a.begin(), a.end(), 0) + std::accumulate(d.begin(), d.end(), 0));
+	}
+
+
+	TEST_F(FlattenTest, ZipIter)
+	{
+		std::list<int> l(a.begin(), a.end());
+
+		auto first = it::zipIter(it::zipIter(a.begin(), b.begin()), l.begin());
+
+		static_assert(std::is_same< decltype(first), it::ZipIter< std::vector<int>::iterator, std::vector<double>::iterator, std::list<int>::iterator > >::value,
+		              "A nested zipIter is flat");
+
+		++first;
+
+		EXPECT_EQ(*first, std::make_tuple(a[1], b[1], a[1]));
+	}
+}
@@ -0,0 +1,150 @@
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "ZipIter/GroupBy.h"
+
+
+namespace
+{
+	struct GroupByTest : public ::testing::Test
+	{
+		GroupByTest () {}
+
+		virtual ~GroupByTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				keys.push_back(std::uniform_int_distribution<>(0, 200)(gen));
+				vals.push_back(std::uniform_int_distribution<>(-100, 100)(gen));
+				weights.push_back(0.25 * i);
+
+				auto& e = expected[keys.back()];
+
+				if(!e.count)
+					e.min = e.max = vals.back();
+
+				e.sum += vals.back();
+				e.min = std::min(e.min, vals.back());
+				e.max = std::max(e.max, vals.back());
+				e.dot += vals.back() * weights.back();
+				e.count++;
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// Checks a result of the form (keys, sum, min, max, count, custom)
+		template <class Result>
+		void check (const Result& res)
+		{
+			ASSERT_EQ(std::get<0>(res).size(), expected.size());
+
+			for(std::size_t i = 0; i < std::get<0>(res).size(); ++i)
+			{
+				const auto& e = expected[std::get<0>(res)[i]];
+
+				EXPECT_EQ(std::get<1>(res)[i], e.sum);
+				EXPECT_EQ(std::get<2>(res)[i], e.min);
+				EXPECT_EQ(std::get<3>(res)[i], e.max);
+				EXPECT_EQ(std::get<4>(res)[i], e.count);
+				EXPECT_DOUBLE_EQ(std::get<5>(res)[i], e.dot);
+			}
+		}
+
+
+		struct Expected
+		{
+			long long sum = 0;
+			long long min = 0, max = 0;
+			std::size_t count = 0;
+			double dot = 0.0;
+		};
+
+
+		int n = 5000;
+
+		std::vector<int> keys;
+		std::vector<long long> vals;
+		std::vector<double> weights;
+
+		std::map<int, Expected> expected;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(GroupByTest, Sequential)
+	{
+		auto res = it::groupBy(it::zip(keys, vals, weights), it::agg::sum<1>(), it::agg::min<1>(), it::agg::max<1>(),
+		                       it::agg::count(), it::agg::reduce(0.0, [](double& acc, int, long long v, double w){ acc += v * w; }));
+
+		check(res);
+
+
+		/// Order of first appearance
+		std::vector<int> order;
+
+		for(int k : keys)
+			if(std::find(order.begin(), order.end(), k) == order.end())
+				order.push_back(k);
+
+		EXPECT_EQ(std::get<0>(res), order);
+	}
+
+
+	TEST_F(GroupByTest, Parallel)
+	{
+		for(std::size_t threads : { 1, 3, 4 })
+		{
+			auto res = it::groupByParallel(it::zip(keys, vals, weights), threads, it::agg::sum<1>(), it::agg::min<1>(),
+			                               it::agg::max<1>(), it::agg::count(),
+			                               it::agg::reduce(0.0, [](double& acc, int, long long v, double w){ acc += v * w; }));
+
+			check(res);
+		}
+	}
+
+
+	TEST_F(GroupByTest, StringKeys)
+	{
+		std::vector<std::string> names = { "a", "b", "a", "c", "b", "a" };
+		std::vector<int> values = { 1, 2, 3, 4, 5, 6 };
+
+		auto res = it::groupBy(it::zip(names, values), it::agg::sum<1>());
+
+		EXPECT_EQ(std::get<0>(res), std::vector<std::string>({ "a", "b", "c" }));
+		EXPECT_EQ(std::get<1>(res), std::vector<int>({ 10, 7, 4 }));
+	}
+
+
+	TEST(HashIndexTest, InsertFind)
+	{
+		it::HashIndex<int> index;
+
+		for(int i = 0; i < 1000; ++i)
+		{
+			auto ins = index.insert(3 * i);
+
+			EXPECT_EQ(ins.first, std::size_t(i));
+			EXPECT_TRUE(ins.second);
+		}
+
+		EXPECT_FALSE(index.insert(300).second);
+		EXPECT_EQ(index.size(), 1000);
+
+		for(int i = 0; i < 3000; ++i)
+			EXPECT_EQ(index.find(i), i % 3 ? it::HashIndex<int>::npos : std::size_t(i / 3));
+	}
+
+
+} // namespace
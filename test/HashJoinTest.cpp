@@ -0,0 +1,105 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/HashJoin.h"
+
+
+namespace
+{
+	struct HashJoinTest : public ::testing::Test
+	{
+		HashJoinTest () {}
+
+		virtual ~HashJoinTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < 300; ++i)
+			{
+				lkey.push_back(std::uniform_int_distribution<>(0, 100)(gen));
+				lval.push_back(10.0 * i);
+			}
+
+			for(int i = 0; i < 2000; ++i)
+			{
+				rkey.push_back(std::uniform_int_distribution<>(50, 500)(gen));
+				rval.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// All matching pairs, found by brute force, sorted
+		std::vector<std::pair<std::size_t, std::size_t>> expected ()
+		{
+			std::vector<std::pair<std::size_t, std::size_t>> res;
+
+			for(std::size_t l = 0; l < lkey.size(); ++l)
+				for(std::size_t r = 0; r < rkey.size(); ++r)
+					if(lkey[l] == rkey[r])
+						res.emplace_back(l, r);
+
+			return res;
+		}
+
+		static std::vector<std::pair<std::size_t, std::size_t>> sorted (const it::JoinRows& rows)
+		{
+			std::vector<std::pair<std::size_t, std::size_t>> res;
+
+			for(std::size_t i = 0; i < rows.size(); ++i)
+				res.emplace_back(rows.left[i], rows.right[i]);
+
+			std::sort(res.begin(), res.end());
+
+			return res;
+		}
+
+
+		std::vector<int> lkey, rkey;
+		std::vector<double> lval;
+		std::vector<std::string> rval;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(HashJoinTest, Rows)
+	{
+		auto exp = expected();
+
+		EXPECT_EQ(sorted(it::hashJoinRows(it::zip(lkey, lval), it::zip(rkey, rval))), exp);
+		EXPECT_EQ(sorted(it::hashJoinRows(it::zip(rkey, rval), it::zip(lkey, lval))).size(), exp.size());
+	}
+
+
+	TEST_F(HashJoinTest, Partitioned)
+	{
+		auto exp = expected();
+
+		for(std::size_t partitions : { 2, 7, 64 })
+			EXPECT_EQ(sorted(it::hashJoinRows(it::zip(lkey, lval), it::zip(rkey, rval), partitions)), exp);
+	}
+
+
+	TEST_F(HashJoinTest, Materialized)
+	{
+		auto res = it::hashJoin(it::zip(lkey, lval), it::zip(rkey, rval));
+
+		ASSERT_EQ(std::get<0>(res).size(), expected().size());
+
+		for(auto tup : it::zip(std::get<0>(res), std::get<1>(res), std::get<2>(res))) it::unZip(tup, [&](int key, double l, const std::string& r)
+		{
+			EXPECT_EQ(lkey[std::size_t(l / 10)], key);
+			EXPECT_EQ(rkey[std::stoi(r)], key);
+		});
+	}
+
+
+} // namespace
@@ -0,0 +1,128 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Members.h"
+
+
+namespace
+{
+	struct Record
+	{
+		int id;
+		double price;
+		std::string name;
+		long qty;
+	};
+
+
+	struct MembersTest : public ::testing::Test
+	{
+		MembersTest () {}
+
+		virtual ~MembersTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+				records.push_back({ i, 1.5 * (n - i), std::to_string(i), 2L * i });
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 3000;
+
+		std::vector<Record> records;
+	};
+
+
+
+
+
+	TEST_F(MembersTest, Looping)
+	{
+		double sum = 0.0;
+
+		for(auto tup : it::zipMembers(records, &Record::price, &Record::qty)) it::unZip(tup, [&](double& price, long& qty)
+		{
+			sum += price * qty;
+			price = 0.0;
+		});
+
+		double expected = 0.0;
+
+		for(int i = 0; i < n; ++i)
+			expected += 1.5 * (n - i) * 2L * i;
+
+		EXPECT_DOUBLE_EQ(sum, expected);
+
+		for(const auto& r : records)
+			EXPECT_EQ(r.price, 0.0);
+	}
+
+
+	TEST_F(MembersTest, Sorting)
+	{
+		auto zipped = it::zipMembers(records, &Record::price, &Record::id);
+
+		std::sort(zipped.begin(), zipped.end());
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(records[i].price, 1.5 * (i + 1));
+			EXPECT_EQ(records[i].id, n - i - 1);
+			EXPECT_EQ(records[i].name, std::to_string(i));
+		}
+
+		EXPECT_EQ(std::get<1>(zipped[5]), n - 6);
+	}
+
+
+	TEST_F(MembersTest, ConstRecords)
+	{
+		const auto& crecords = records;
+
+		auto zipped = it::zipMembers(crecords, &Record::name, &Record::id);
+
+		int count = 0;
+
+		for(auto tup : zipped)
+			count += std::get<0>(tup) == std::to_string(std::get<1>(tup));
+
+		EXPECT_EQ(count, n);
+	}
+
+
+	TEST_F(MembersTest, Transpose)
+	{
+		auto columns = it::toSoA(records, &Record::id, &Record::name, &Record::qty);
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(std::get<0>(columns)[i], i);
+			EXPECT_EQ(std::get<1>(columns)[i], std::to_string(i));
+			EXPECT_EQ(std::get<2>(columns)[i], 2L * i);
+		}
+
+		std::reverse(std::get<1>(columns).begin(), std::get<1>(columns).end());
+
+		it::toAoS(it::zip(std::get<1>(columns), std::get<2>(columns)), records, &Record::name, &Record::qty);
+
+		auto back = it::toAoS(it::zip(std::get<0>(columns), std::get<1>(columns)), &Record::id, &Record::name);
+
+		ASSERT_EQ(back.size(), records.size());
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(records[i].name, std::to_string(n - i - 1));
+			EXPECT_EQ(records[i].price, 1.5 * (n - i));
+			EXPECT_EQ(back[i].id, i);
+			EXPECT_EQ(back[i].name, records[i].name);
+		}
+	}
+
+
+} // namespace
@@ -0,0 +1,196 @@
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Nullable.h"
+
+
+namespace
+{
+	struct NullableTest : public ::testing::Test
+	{
+		NullableTest () {}
+
+		virtual ~NullableTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				/// Runs of nulls, runs of valid values and mixed stretches, to cover every kind of word
+				bool valid = i < 200 ? true : i < 400 ? false : std::uniform_int_distribution<>(0, 2)(gen) > 0;
+
+				if(valid)
+					prices.push_back(0.5 * i);
+
+				else
+					prices.push_back(it::null);
+
+				expectedValid.push_back(valid);
+				ids.push_back(i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 1000;
+
+		it::Nullable<std::vector<double>> prices;
+		std::vector<int> ids;
+
+		std::vector<bool> expectedValid;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(NullableTest, Zip)
+	{
+		ASSERT_EQ(prices.size(), std::size_t(n));
+
+		int i = 0, nulls = 0;
+
+		for(auto tup : it::zip(prices, ids))
+		{
+			it::unZip(tup, [&](it::NullableRef<double> price, int id)
+			{
+				EXPECT_EQ(bool(price), bool(expectedValid[id]));
+				EXPECT_EQ(price.value_or(-1.0), expectedValid[id] ? 0.5 * id : -1.0);
+
+				if(price == it::null)
+				{
+					EXPECT_THROW(price.value(), std::runtime_error);
+					nulls++;
+				}
+			});
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n);
+		EXPECT_EQ(prices.nullCount(), std::size_t(nulls));
+
+		it::forEach(prices, ids, [](it::NullableRef<double> price, int id)
+		{
+			if(id % 10 == 0)
+				price = it::null;
+
+			else if(!price)
+				price = 1.0;
+		});
+
+		for(int k = 0; k < n; ++k)
+		{
+			EXPECT_EQ(prices.valid(k), k % 10 != 0);
+
+			if(k % 10 && !expectedValid[k])
+			{
+				EXPECT_EQ(*prices[k], 1.0);
+			}
+		}
+	}
+
+
+	TEST_F(NullableTest, Reduce)
+	{
+		double sum = 0.0;
+		std::size_t count = 0;
+
+		for(int k = 0; k < n; ++k) if(expectedValid[k])
+		{
+			sum += 0.5 * k;
+			count++;
+		}
+
+		EXPECT_DOUBLE_EQ(it::reduce(prices, 0.0), sum);
+
+		std::size_t visited = 0;
+		int last = -1;
+
+		it::forEachValid(prices, [&](std::size_t row, double price)
+		{
+			EXPECT_TRUE(expectedValid[row]);
+			EXPECT_EQ(price, 0.5 * row);
+			EXPECT_GT(int(row), last);
+
+			last = int(row);
+			visited++;
+		});
+
+		EXPECT_EQ(visited, count);
+		EXPECT_EQ(prices.nullCount(), n - count);
+	}
+
+
+	TEST_F(NullableTest, Compact)
+	{
+		std::vector<int> keptIds;
+		std::vector<double> keptPrices;
+
+		for(int k = 0; k < n; ++k) if(expectedValid[k])
+		{
+			keptIds.push_back(k);
+			keptPrices.push_back(0.5 * k);
+		}
+
+		std::size_t size = it::compactNulls(prices, it::zip(ids, prices.values()));
+
+		ASSERT_EQ(size, keptIds.size());
+
+		ids.resize(size);
+		prices.values().resize(size);
+
+		EXPECT_EQ(ids, keptIds);
+		EXPECT_EQ(prices.values(), keptPrices);
+
+
+		it::Nullable<std::vector<int>> full(std::vector<int>(130, 7));
+
+		EXPECT_EQ(full.nullCount(), 0u);
+		EXPECT_EQ(it::reduce(full, 0), 7 * 130);
+		EXPECT_EQ(it::compactNulls(full, it::zip(full.values())), 130u);
+	}
+
+
+	TEST_F(NullableTest, Sort)
+	{
+		/// Keys in reverse order, so every row moves
+		std::vector<int> keys(ids.rbegin(), ids.rend());
+
+		auto expectAligned = [&]
+		{
+			for(int k = 0; k < n; ++k)
+			{
+				int id = n - 1 - keys[k];
+
+				ASSERT_EQ(keys[k], k);
+				EXPECT_EQ(prices.valid(k), bool(expectedValid[id]));
+
+				if(expectedValid[id])
+				{
+					EXPECT_EQ(*prices[k], 0.5 * id);
+				}
+			}
+		};
+
+		std::sort(ZIP_ALL(keys, prices), [](const auto& x, const auto& y){ return std::get<0>(x) < std::get<0>(y); });
+
+		expectAligned();
+
+
+		std::reverse(keys.begin(), keys.end());
+		std::reverse(ZIP_ALL(prices));
+
+		it::ScratchArena arena;
+
+		it::sort(it::zip(keys, prices), arena);
+
+		expectAligned();
+	}
+}
@@ -0,0 +1,53 @@
+#include <vector>
+#include <numeric>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ZipIter.h"
+#include "ZipIter/PerfCounters.h"
+
+
+namespace
+{
+	/// The counters may not be accessible where the tests run, so only consistency is checked
+	TEST(PerfCountersTest, Measure)
+	{
+		std::vector<double> v(100000, 1.0), u(100000, 2.0);
+
+		double sum = 0.0;
+
+		auto sample = it::perf::measure([&]
+		{
+			it::forEach(v, u, [&](double x, double y){ sum += x * y; });
+		});
+
+		EXPECT_EQ(sum, 200000.0);
+		EXPECT_GT(sample.seconds, 0.0);
+
+		it::perf::Counters counters;
+
+		for(int e = 0; e < it::perf::numEvents; ++e)
+			EXPECT_TRUE(counters.available(e) || !sample.available(e));
+
+		EXPECT_TRUE(!sample.available(it::perf::instructions) || sample.values[it::perf::instructions] > 100000.0);
+	}
+
+
+	TEST(PerfCountersTest, Report)
+	{
+		it::perf::Sample sample;
+
+		sample.seconds = 1e-6;
+		sample.values[it::perf::cycles] = 4000.0;
+
+		std::ostringstream out;
+
+		it::perf::report(out, "kernel", sample, 1000);
+
+		EXPECT_NE(out.str().find("1.000 ns"), std::string::npos);
+		EXPECT_NE(out.str().find("cycles:    4.000"), std::string::npos);
+		EXPECT_NE(out.str().find("dTLB misses:      n/a"), std::string::npos);
+	}
+
+
+} // namespace
@@ -0,0 +1,124 @@
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Pipeline.h"
+
+
+namespace
+{
+	struct PipelineTest : public ::testing::Test
+	{
+		PipelineTest () {}
+
+		virtual ~PipelineTest () { }
+
+		virtual void SetUp ()
+		{
+			raw.resize(n);
+			decoded.resize(n);
+			enriched.resize(n);
+
+			std::iota(raw.begin(), raw.end(), 0);
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 100000;
+
+		std::vector<int> raw;
+		std::vector<long> decoded;
+		std::vector<double> enriched;
+	};
+
+
+
+
+
+	TEST_F(PipelineTest, ThreeStages)
+	{
+		long total = 0;
+		std::size_t batches = 0, lastRow = 0;
+		bool ordered = true;
+
+		it::pipeline(it::zip(raw, decoded, enriched), 1000,
+			it::perRow([](int r, long& d, double&){ d = 3L * r; }),
+			it::perRow([](int, long d, double& e){ e = 0.5 * d; }),
+			[&](auto first, auto last)
+			{
+				ordered = ordered && std::get<0>(*first) == int(lastRow);
+				lastRow += last - first;
+				++batches;
+
+				std::for_each(first, last, it::unZip([&](int, long d, double){ total += d; }));
+			});
+
+		EXPECT_TRUE(ordered);
+		EXPECT_EQ(batches, 100);
+		EXPECT_EQ(total, 3L * n * (n - 1) / 2);
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(enriched[i], 1.5 * i);
+	}
+
+
+	TEST_F(PipelineTest, SingleStageAndShallowQueue)
+	{
+		it::PipelineOptions options;
+
+		options.batchSize = 333;
+		options.depth = 1;
+
+		it::pipeline(it::zip(raw, decoded), options, it::perRow([](int r, long& d){ d = r + 1; }));
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(decoded[i], i + 1);
+
+		it::pipeline(it::zip(raw, decoded), options, it::perRow([](int r, long& d){ d = r; }),
+		                                             it::perRow([](int, long& d){ d *= 2; }));
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(decoded[i], 2 * i);
+	}
+
+
+	TEST_F(PipelineTest, Exception)
+	{
+		auto run = [&]
+		{
+			it::pipeline(it::zip(raw, decoded), 100,
+				it::perRow([](int r, long& d){ d = r; }),
+				it::perRow([](int r, long&){ if(r == 5000) throw std::runtime_error("bad row"); }),
+				it::perRow([](int, long&){}));
+		};
+
+		EXPECT_THROW(run(), std::runtime_error);
+	}
+
+
+	TEST(SpscQueueTest, Order)
+	{
+		it::SpscQueue<int> queue(7);
+		std::atomic<bool> stop{ false };
+
+		std::thread producer([&]
+		{
+			for(int i = 0; i < 10000; ++i)
+				queue.push(i, stop);
+		});
+
+		int value, expected = 0;
+
+		for(int i = 0; i < 10000; ++i)
+			if(queue.pop(value, stop))
+				expected += value == i;
+
+		producer.join();
+
+		EXPECT_EQ(expected, 10000);
+	}
+
+
+} // namespace
@@ -0,0 +1,129 @@
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include <csignal>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ProcPar.h"
+
+
+namespace
+{
+	struct ProcParTest : public ::testing::Test
+	{
+		ProcParTest () {}
+
+		virtual ~ProcParTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				ids.push_back(i);
+				prices.push_back(0.5 * i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 10007;
+
+		std::vector<int> ids;
+		std::vector<double> prices;
+	};
+
+
+
+
+
+	TEST_F(ProcParTest, ForEach)
+	{
+		std::vector<long> squares(n);
+
+		it::procPar::forEach(it::zip(ids, prices, squares), [](int id, double& price, long& square)
+		{
+			price *= 2;
+			square = long(id) * id;
+		}, 4);
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(prices[i], double(i));
+			EXPECT_EQ(squares[i], long(i) * i);
+		}
+
+
+		/// More processes than rows, and a single process
+		std::vector<int> few = { 1, 2, 3 };
+
+		it::procPar::forEach(it::zip(few), [](int& x){ x = -x; }, 8);
+		it::procPar::forEach(it::zip(few), [](int& x){ x *= 10; }, 1);
+
+		EXPECT_EQ(few, std::vector<int>({ -10, -20, -30 }));
+	}
+
+
+	TEST_F(ProcParTest, SharedColumn)
+	{
+		it::SharedColumn<double> shared(prices.begin(), prices.end());
+		it::SharedColumn<int> counts(n, 1);
+
+		ASSERT_EQ(shared.size(), std::size_t(n));
+
+		it::procPar::forEach(it::zip(ids, shared, counts), [](int id, double& price, int& count)
+		{
+			price += id;
+			count += id % 3;
+		}, 3);
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(shared[i], 1.5 * i);
+			EXPECT_EQ(counts[i], 1 + i % 3);
+		}
+	}
+
+
+	TEST_F(ProcParTest, Reduce)
+	{
+		double expected = std::accumulate(prices.begin(), prices.end(), 0.0);
+
+		double sum = it::procPar::reduce(it::zip(ids, prices), 0.0, [](double acc, int, double price){ return acc + price; }, 4);
+
+		EXPECT_DOUBLE_EQ(sum, expected);
+
+
+		auto maxId = [](int acc, int id, double){ return std::max(acc, id); };
+		auto combine = [](int a, int b){ return std::max(a, b); };
+
+		EXPECT_EQ(it::procPar::reduce(it::zip(ids, prices), -1, maxId, 5, combine), n - 1);
+	}
+
+
+	TEST_F(ProcParTest, Failure)
+	{
+		EXPECT_THROW(it::procPar::forEach(it::zip(ids), [](int id)
+		{
+			if(id == 5000)
+				throw std::runtime_error("Bad row");
+		}, 4), std::runtime_error);
+
+
+		/// With SIGCHLD ignored the workers cannot be waited for, which must not pass as a success
+		auto previous = std::signal(SIGCHLD, SIG_IGN);
+
+		std::vector<int> copy = ids;
+
+		EXPECT_THROW(it::procPar::forEach(it::zip(copy), [](int& id)
+		{
+			id = -1;
+
+			throw std::runtime_error("Bad row");
+		}, 4), std::runtime_error);
+
+		std::signal(SIGCHLD, previous);
+
+		EXPECT_EQ(copy, ids);
+	}
+}
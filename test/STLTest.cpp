@@ -1,4 +1,5 @@
 #include <vector>
+#include <array>
 #include <list>
 #include <set>
 #include <algorithm>
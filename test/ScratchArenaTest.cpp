@@ -0,0 +1,166 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ScratchArena.h"
+
+
+namespace
+{
+	struct ScratchArenaTest : public ::testing::Test
+	{
+		ScratchArenaTest () {}
+
+		virtual ~ScratchArenaTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(0, 50)(gen));
+				b.push_back(i);
+				c.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 5000;
+
+		std::vector<int> a;
+		std::vector<int> b;
+		std::vector<std::string> c;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(ScratchArenaTest, Arena)
+	{
+		it::ScratchArena arena(100);
+
+		{
+			it::ScratchArena::Scope scope(arena);
+
+			char* p = static_cast<char*>(arena.allocate(10));
+			double* q = arena.allocate<double>(1000);
+
+			EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0u);
+			EXPECT_EQ(reinterpret_cast<std::uintptr_t>(q) % 64, 0u);
+			EXPECT_GE(reinterpret_cast<char*>(q), p + 10);
+
+			std::fill(q, q + 1000, 1.0);
+
+			EXPECT_EQ(arena.counters().allocations, 2u);
+			EXPECT_EQ(arena.counters().used, 64u + 8000u);
+		}
+
+		/// Released, so the two blocks become one with their total size
+		EXPECT_EQ(arena.counters().used, 0u);
+		EXPECT_EQ(arena.counters().allocations, 3u);
+
+		std::size_t reserved = arena.counters().reserved;
+
+		{
+			it::ScratchArena::Scope scope(arena);
+
+			arena.allocate(10);
+			arena.allocate<double>(1000);
+		}
+
+		EXPECT_EQ(arena.counters().allocations, 3u);
+		EXPECT_EQ(arena.counters().reserved, reserved);
+		EXPECT_EQ(arena.counters().peak, 64u + 8000u);
+	}
+
+
+	TEST_F(ScratchArenaTest, Sort)
+	{
+		auto auxA = a;
+		auto auxB = b;
+		auto auxC = c;
+
+		std::stable_sort(ZIP_ALL(auxA, auxB, auxC), [](const auto& x, const auto& y){ return std::get<0>(x) > std::get<0>(y); });
+
+		it::ScratchArena arena;
+
+		auto order = it::argsort(it::zip(a, b, c), arena, std::greater<>());
+
+		for(std::size_t i = 0; i < order.size(); ++i)
+			EXPECT_EQ(b[order[i]], auxB[i]);
+
+		it::sort(it::zip(a, b, c), arena, std::greater<>());
+
+		EXPECT_EQ(a, auxA);
+		EXPECT_EQ(b, auxB);
+		EXPECT_EQ(c, auxC);
+	}
+
+
+	TEST_F(ScratchArenaTest, MergePartition)
+	{
+		std::sort(a.begin(), a.begin() + 3000);
+		std::sort(a.begin() + 3000, a.end());
+
+		auto auxA = a;
+		auto auxB = b;
+		auto auxC = c;
+
+		std::inplace_merge(it::zipBegin(auxA, auxB, auxC), it::zipBegin(auxA, auxB, auxC) + 3000, it::zipEnd(auxA, auxB, auxC),
+		                   [](const auto& x, const auto& y){ return std::get<0>(x) < std::get<0>(y); });
+
+		it::ScratchArena arena;
+
+		it::merge(it::zip(a, b, c), 3000, arena);
+
+		EXPECT_EQ(a, auxA);
+		EXPECT_EQ(b, auxB);
+		EXPECT_EQ(c, auxC);
+
+
+		auto pred = [](int x, int y, const std::string&){ return x % 3 == 0 || y < 100; };
+
+		auto mid = std::stable_partition(ZIP_ALL(auxA, auxB, auxC), it::unZip(pred));
+
+		EXPECT_EQ(it::partition(it::zip(a, b, c), pred, arena), std::size_t(mid - it::zipBegin(auxA, auxB, auxC)));
+
+		EXPECT_EQ(a, auxA);
+		EXPECT_EQ(b, auxB);
+		EXPECT_EQ(c, auxC);
+	}
+
+
+	TEST_F(ScratchArenaTest, SteadyState)
+	{
+		it::ScratchArena& arena = it::ScratchArena::local();
+
+		for(int i = 0; i < 2; ++i)
+		{
+			it::sort(it::zip(a, b, c), arena);
+			it::merge(it::zip(a, b, c), 2500, arena);
+			it::partition(it::zip(a, b, c), [](int x, int, const std::string&){ return x < 25; }, arena);
+		}
+
+		std::size_t allocations = arena.counters().allocations;
+
+		for(int i = 0; i < 5; ++i)
+		{
+			std::shuffle(ZIP_ALL(a, b, c), gen);
+
+			it::sort(it::zip(a, b, c), arena);
+			it::merge(it::zip(a, b, c), 2500, arena);
+			it::partition(it::zip(a, b, c), [](int x, int, const std::string&){ return x < 25; }, arena);
+		}
+
+		EXPECT_EQ(arena.counters().allocations, allocations);
+		EXPECT_EQ(arena.counters().used, 0u);
+	}
+}
@@ -0,0 +1,112 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/SearchIndex.h"
+
+
+namespace
+{
+	struct SearchIndexTest : public ::testing::Test
+	{
+		SearchIndexTest () {}
+
+		virtual ~SearchIndexTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				keys.push_back(std::uniform_int_distribution<>(0, 3 * n)(gen));
+				values.push_back(std::to_string(i));
+			}
+
+			std::sort(ZIP_ALL(keys, values));
+
+			for(int i = 0; i < 5000; ++i)
+				queries.push_back(std::uniform_int_distribution<>(-10, 3 * n + 10)(gen));
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 10000;
+
+		std::vector<int> keys;
+		std::vector<std::string> values;
+
+		std::vector<int> queries;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(SearchIndexTest, Bounds)
+	{
+		auto index = it::makeSearchIndex(it::zip(keys, values));
+
+		ASSERT_EQ(index.size(), keys.size());
+
+		for(int x : queries)
+		{
+			std::size_t lower = std::lower_bound(keys.begin(), keys.end(), x) - keys.begin();
+			std::size_t upper = std::upper_bound(keys.begin(), keys.end(), x) - keys.begin();
+
+			EXPECT_EQ(index.lowerBound(x), lower);
+			EXPECT_EQ(index.upperBound(x), upper);
+			EXPECT_EQ(index.find(x), lower < upper ? lower : index.npos);
+		}
+	}
+
+
+	TEST_F(SearchIndexTest, Batched)
+	{
+		auto zipped = it::zip(keys, values);
+
+		auto index = it::makeSearchIndex(zipped);
+
+		std::vector<std::size_t> rows(queries.size());
+
+		index.lowerBound(queries.begin(), queries.end(), rows.begin());
+
+		for(std::size_t i = 0; i < queries.size(); ++i)
+		{
+			EXPECT_EQ(rows[i], index.lowerBound(queries[i]));
+
+			if(rows[i] < keys.size())
+			{
+				EXPECT_EQ(std::get<1>(zipped[rows[i]]), values[rows[i]]);
+			}
+		}
+	}
+
+
+	TEST_F(SearchIndexTest, Sizes)
+	{
+		for(int size : { 0, 1, 2, 3, 7, 8, 100 })
+		{
+			std::vector<double> sorted;
+
+			for(int i = 0; i < size; ++i)
+				sorted.push_back(2.0 * i);
+
+			it::SearchIndex<double> index(sorted);
+
+			for(double x = -1.0; x <= 2.0 * size; x += 0.5)
+			{
+				EXPECT_EQ(index.lowerBound(x), std::size_t(std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin()));
+				EXPECT_EQ(index.upperBound(x), std::size_t(std::upper_bound(sorted.begin(), sorted.end(), x) - sorted.begin()));
+			}
+		}
+
+		it::SearchIndex<int> empty;
+
+		EXPECT_EQ(empty.lowerBound(5), 0u);
+		EXPECT_EQ(empty.find(5), empty.npos);
+	}
+}
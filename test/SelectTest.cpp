@@ -0,0 +1,119 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ScratchArena.h"
+
+
+namespace
+{
+	struct SelectTest : public ::testing::Test
+	{
+		SelectTest () {}
+
+		virtual ~SelectTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(0, 20)(gen));
+				b.push_back(std::uniform_int_distribution<>(0, 20)(gen));
+				c.push_back(std::to_string(i));
+				d.push_back(0.5 * i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 2000;
+
+		std::vector<int> a;
+		std::vector<long> b;
+		std::vector<std::string> c;
+		std::vector<double> d;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(SelectTest, Projection)
+	{
+		auto zipped = it::zip(a, b, c, d);
+
+		auto proj = zipped.select<3, 0>();
+
+		static_assert(decltype(proj)::containersSize == 2, "Two columns");
+
+		EXPECT_EQ(proj.size(), a.size());
+		EXPECT_EQ(&proj.get<0>(), &d);
+		EXPECT_EQ(&proj.get<1>(), &a);
+
+		int i = 0;
+
+		for(auto tup : proj)
+		{
+			static_assert(std::tuple_size<decltype(tup)>::value == 2, "Two elements per row");
+
+			it::unZip(tup, [&](double& x, int& y)
+			{
+				EXPECT_EQ(x, d[i]);
+				EXPECT_EQ(y, a[i]);
+
+				x = -x;
+			});
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n);
+		EXPECT_EQ(d[10], -5.0);
+
+		auto byType = zipped.select<std::string, long>();
+
+		EXPECT_EQ(&byType.get<0>(), &c);
+		EXPECT_EQ(&byType.get<1>(), &b);
+
+		const auto& constZipped = zipped;
+
+		EXPECT_EQ(std::get<0>(constZipped.select<2>()[5]), c[5]);
+	}
+
+
+	TEST_F(SelectTest, SortBy)
+	{
+		auto auxA = a;
+		auto auxB = b;
+		auto auxC = c;
+		auto auxD = d;
+
+		std::stable_sort(ZIP_ALL(auxA, auxB, auxC, auxD), [](const auto& x, const auto& y)
+		{
+			return std::tie(std::get<1>(x), std::get<0>(x)) < std::tie(std::get<1>(y), std::get<0>(y));
+		});
+
+		it::ScratchArena arena;
+
+		auto order = it::argsortBy<1, 0>(it::zip(a, b, c, d), arena);
+
+		for(std::size_t i = 0; i < order.size(); ++i)
+			EXPECT_EQ(c[order[i]], auxC[i]);
+
+		it::sortBy<1, 0>(it::zip(a, b, c, d), arena);
+
+		EXPECT_EQ(a, auxA);
+		EXPECT_EQ(b, auxB);
+		EXPECT_EQ(c, auxC);
+		EXPECT_EQ(d, auxD);
+
+		it::sortBy<3>(it::zip(a, b, c, d), arena, std::greater<>());
+
+		EXPECT_TRUE(std::is_sorted(d.begin(), d.end(), std::greater<>()));
+	}
+}
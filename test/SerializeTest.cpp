@@ -0,0 +1,159 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Serialize.h"
+
+
+namespace
+{
+	struct SerializeTest : public ::testing::Test
+	{
+		SerializeTest () {}
+
+		virtual ~SerializeTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				sorted.push_back(1000 + 3 * i + std::uniform_int_distribution<>(0, 2)(gen));
+				small.push_back(std::uniform_int_distribution<>(-20, 20)(gen));
+				runs.push_back(std::uint8_t(i / 700));
+				noise.push_back(std::uniform_int_distribution<std::uint64_t>()(gen));
+				doubles.push_back(0.25 * i);
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 10000;
+
+		std::vector<long long> sorted;
+		std::vector<short> small;
+		std::vector<std::uint8_t> runs;
+		std::vector<std::uint64_t> noise;
+		std::vector<double> doubles;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(SerializeTest, RoundTrip)
+	{
+		for(std::size_t threads : { 1, 3 })
+		{
+			std::stringstream stream;
+
+			it::write(stream, it::zip(sorted, small, runs, noise, doubles), 1000);
+
+			auto res = it::read<long long, short, std::uint8_t, std::uint64_t, double>(stream, threads);
+
+			EXPECT_EQ(std::get<0>(res), sorted);
+			EXPECT_EQ(std::get<1>(res), small);
+			EXPECT_EQ(std::get<2>(res), runs);
+			EXPECT_EQ(std::get<3>(res), noise);
+			EXPECT_EQ(std::get<4>(res), doubles);
+		}
+	}
+
+
+	TEST_F(SerializeTest, Compression)
+	{
+		std::stringstream stream;
+
+		it::write(stream, it::zip(sorted, small, runs));
+
+		std::size_t raw = n * (sizeof(long long) + sizeof(short) + sizeof(std::uint8_t));
+
+		EXPECT_LT(stream.str().size(), raw / 4);
+	}
+
+
+	TEST_F(SerializeTest, EdgeValues)
+	{
+		std::vector<int> a = { std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 0, -1,
+		                       std::numeric_limits<int>::max(), std::numeric_limits<int>::min() };
+		std::vector<std::int64_t> b = { std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::int64_t>::min(),
+		                                7, 7, 7, -7 };
+		std::vector<bool> c = { true, false, true, true, false, false };
+
+		for(std::size_t blockRows : { 1, 2, 4, 100 })
+		{
+			std::stringstream stream;
+
+			it::write(stream, it::zip(a, b, c), blockRows);
+
+			auto res = it::read<int, std::int64_t, bool>(stream);
+
+			EXPECT_EQ(std::get<0>(res), a);
+			EXPECT_EQ(std::get<1>(res), b);
+			EXPECT_EQ(std::get<2>(res), c);
+		}
+
+		std::stringstream empty;
+
+		it::write(empty, it::zip(std::vector<int>(), std::vector<float>()));
+
+		EXPECT_TRUE(std::get<0>(it::read<int, float>(empty)).empty());
+	}
+
+
+	TEST_F(SerializeTest, IntoColumns)
+	{
+		std::stringstream stream;
+
+		it::write(stream, it::zip(sorted, doubles), 512);
+
+		std::vector<long long> a(n + 5, -1);
+		double b[20000];
+
+		EXPECT_EQ(it::read(stream, it::zip(a, b), 2), std::size_t(n));
+
+		EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), a.begin()));
+		EXPECT_TRUE(std::equal(doubles.begin(), doubles.end(), b));
+		EXPECT_EQ(a.back(), -1);
+	}
+
+
+	TEST_F(SerializeTest, Errors)
+	{
+		std::stringstream stream;
+
+		it::write(stream, it::zip(sorted, small), 1000);
+
+		std::string data = stream.str();
+
+		std::stringstream wrongTypes(data);
+		EXPECT_THROW((it::read<long long, int>(wrongTypes)), std::runtime_error);
+
+		std::stringstream truncated(data.substr(0, data.size() / 2));
+		EXPECT_THROW((it::read<long long, short>(truncated)), std::runtime_error);
+
+		std::stringstream garbage("not a columnar file at all, really not");
+		EXPECT_THROW((it::read<long long, short>(garbage)), std::runtime_error);
+
+		std::vector<long long> a(10);
+		std::vector<short> b(10);
+
+		std::stringstream tooSmall(data);
+		EXPECT_THROW(it::read(tooSmall, it::zip(a, b)), std::runtime_error);
+	}
+
+
+	/// Columns owning memory, as strings, cannot be stored as raw bytes, so 'write' and 'read' do not compile for them
+	TEST_F(SerializeTest, Unsupported)
+	{
+		static_assert(it::help::IsSerializable<long long, double, std::uint8_t>::value, "");
+		static_assert(!it::help::IsSerializable<long long, std::string>::value, "");
+		static_assert(!it::help::IsSerializable<std::vector<int>>::value, "");
+	}
+}
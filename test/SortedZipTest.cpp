@@ -0,0 +1,257 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/SortedZip.h"
+
+
+namespace
+{
+	struct SortedZipTest : public ::testing::Test
+	{
+		SortedZipTest () {}
+
+		virtual ~SortedZipTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				a.push_back(std::uniform_int_distribution<>(0, 200)(gen));
+				b.push_back(i);
+				c.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// The rows of [first, last) sorted as a stable sort of the whole table would
+		void expected (std::vector<int>& auxA, std::vector<int>& auxB, std::vector<std::string>& auxC, int last)
+		{
+			auxA.assign(a.begin(), a.begin() + last);
+			auxB.assign(b.begin(), b.begin() + last);
+			auxC.assign(c.begin(), c.begin() + last);
+
+			std::stable_sort(ZIP_ALL(auxA, auxB, auxC), [](const auto& x, const auto& y){
+				return std::get<0>(x) < std::get<0>(y);
+			});
+		}
+
+
+		int n = 3000;
+
+		std::vector<int> a;
+		std::vector<int> b;
+		std::vector<std::string> c;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(SortedZipTest, MergeBatches)
+	{
+		auto table = it::sortedZip(it::zip(a, b, c));
+
+		ASSERT_EQ(table.size(), a.size());
+
+		for(int i = 0; i < 10; ++i)
+		{
+			std::vector<int> newA, newB;
+			std::vector<std::string> newC;
+
+			for(int j = 0; j < 30; ++j)
+			{
+				newA.push_back(std::uniform_int_distribution<>(-10, 210)(gen));
+				newB.push_back(n + j);
+				newC.push_back(std::to_string(n + j));
+			}
+
+			a.insert(a.end(), newA.begin(), newA.end());
+			b.insert(b.end(), newB.begin(), newB.end());
+			c.insert(c.end(), newC.begin(), newC.end());
+
+			n += 30;
+
+			table.append(it::zip(newA, newB, newC));
+
+			EXPECT_EQ(table.deltaSize(), 30u);
+
+			table.merge();
+
+			EXPECT_EQ(table.deltaSize(), 0u);
+
+			std::vector<int> auxA, auxB;
+			std::vector<std::string> auxC;
+
+			expected(auxA, auxB, auxC, n);
+
+			EXPECT_EQ(table.column<0>(), auxA);
+			EXPECT_EQ(table.column<1>(), auxB);
+			EXPECT_EQ(table.column<2>(), auxC);
+		}
+	}
+
+
+	TEST_F(SortedZipTest, Lookups)
+	{
+		auto table = it::makeSortedZip<int, int, std::string>(std::greater<>());
+
+		table.append(it::zip(a, b, c));
+		table.merge();
+
+		table.insert(500, -1, "x");
+		table.insert(a[0], -2, "y");
+
+		EXPECT_EQ(table.deltaSize(), 2u);
+
+		EXPECT_TRUE(std::is_sorted(table.column<0>().begin(), table.column<0>().end(), std::greater<>()));
+
+
+		for(int key : { -1, 0, 17, 200, 500, a[0] })
+		{
+			std::size_t count = std::count(a.begin(), a.end(), key) + (key == 500) + (key == a[0]);
+
+			EXPECT_EQ(table.count(key), count);
+			EXPECT_EQ(table.contains(key), count != 0);
+		}
+
+
+		std::vector<int> rows;
+
+		table.forEachMatch(a[0], [&](int key, int row, const std::string& name){
+			EXPECT_EQ(key, a[0]);
+			EXPECT_EQ(name, row < 0 ? "y" : std::to_string(row));
+
+			rows.push_back(row);
+		});
+
+		/// Main table rows in insertion order, then the delta
+		ASSERT_FALSE(rows.empty());
+		EXPECT_TRUE(std::is_sorted(rows.begin(), rows.end() - 1));
+		EXPECT_EQ(rows.back(), -2);
+	}
+
+
+	TEST_F(SortedZipTest, DeltaLookups)
+	{
+		auto table = it::makeSortedZip<int, int, std::string>();
+
+		/// Everything stays in the delta, added by single inserts and batches alternately
+		for(int i = 0; i < n; i += 100)
+		{
+			for(int j = i; j < i + 50; ++j)
+				table.insert(a[j], b[j], c[j]);
+
+			table.append(it::zip(std::vector<int>(a.begin() + i + 50, a.begin() + i + 100),
+			                     std::vector<int>(b.begin() + i + 50, b.begin() + i + 100),
+			                     std::vector<std::string>(c.begin() + i + 50, c.begin() + i + 100)));
+		}
+
+		ASSERT_EQ(table.deltaSize(), std::size_t(n));
+
+		for(int key = -1; key <= 201; ++key)
+		{
+			std::vector<int> rows, expectedRows;
+
+			for(int i = 0; i < n; ++i)
+				if(a[i] == key)
+					expectedRows.push_back(i);
+
+			EXPECT_EQ(table.forEachMatch(key, [&](int, int row, const std::string&){ rows.push_back(row); }), expectedRows.size());
+			EXPECT_EQ(rows, expectedRows);
+		}
+
+		table.merge();
+
+		std::vector<int> auxA, auxB;
+		std::vector<std::string> auxC;
+
+		expected(auxA, auxB, auxC, n);
+
+		EXPECT_EQ(table.column<0>(), auxA);
+		EXPECT_EQ(table.column<1>(), auxB);
+		EXPECT_EQ(table.column<2>(), auxC);
+	}
+
+
+	TEST_F(SortedZipTest, SingleInserts)
+	{
+		auto table = it::makeSortedZip<int, int, std::string>();
+
+		auto check = [&](int last)
+		{
+			for(int key : { -1, 0, 17, 100, 200 })
+			{
+				std::vector<int> rows, expectedRows;
+
+				for(int i = 0; i < last; ++i)
+					if(a[i] == key)
+						expectedRows.push_back(i);
+
+				EXPECT_EQ(table.forEachMatch(key, [&](int, int row, const std::string&){ rows.push_back(row); }), expectedRows.size());
+				EXPECT_EQ(rows, expectedRows);
+			}
+		};
+
+		/// Row by row, with lookups on a delta that has sorted rows and rows added after them
+		for(int i = 0; i < n / 2; ++i)
+			table.insert(a[i], b[i], c[i]);
+
+		check(n / 2);
+
+		for(int i = n / 2; i < n; ++i)
+			table.insert(a[i], b[i], c[i]);
+
+		ASSERT_EQ(table.deltaSize(), std::size_t(n));
+
+		check(n);
+
+		table.merge();
+
+		std::vector<int> auxA, auxB;
+		std::vector<std::string> auxC;
+
+		expected(auxA, auxB, auxC, n);
+
+		EXPECT_EQ(table.column<0>(), auxA);
+		EXPECT_EQ(table.column<1>(), auxB);
+		EXPECT_EQ(table.column<2>(), auxC);
+	}
+
+
+	TEST_F(SortedZipTest, MaxDelta)
+	{
+		auto table = it::makeSortedZip<int, int, std::string>(std::less<>(), 100);
+
+		for(int i = 0; i < n; ++i)
+		{
+			table.insert(a[i], b[i], c[i]);
+
+			EXPECT_LE(table.deltaSize(), 100u);
+		}
+
+		table.merge();
+
+		std::vector<int> auxA, auxB;
+		std::vector<std::string> auxC;
+
+		expected(auxA, auxB, auxC, n);
+
+		EXPECT_EQ(table.column<0>(), auxA);
+		EXPECT_EQ(table.column<1>(), auxB);
+
+		int i = 0;
+
+		for(auto row : table.table())
+			EXPECT_EQ(std::get<2>(row), auxC[i++]);
+
+		EXPECT_EQ(i, n);
+	}
+}
@@ -0,0 +1,111 @@
+/// This test is built in its own executable, as the counters change the code of every 'ZipIter'
+#ifndef ZIPITER_STATS
+#define ZIPITER_STATS
+#endif
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ZipIter.h"
+
+
+namespace
+{
+	struct StatsTest : public ::testing::Test
+	{
+		StatsTest () {}
+
+		virtual ~StatsTest () { }
+
+		virtual void SetUp ()
+		{
+			v = std::vector<int>(n);
+			u = std::vector<double>(n);
+
+			std::iota(v.rbegin(), v.rend(), 0);
+			std::iota(u.begin(), u.end(), 0.0);
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 100;
+
+		std::vector<int> v;
+		std::vector<double> u;
+	};
+
+
+
+
+
+	TEST_F(StatsTest, Looping)
+	{
+		it::stats::Scope scope;
+
+		std::for_each(ZIP_ALL(v, u), [](auto){});
+
+		auto counts = scope.counts();
+
+		EXPECT_EQ(counts.increments, n);
+		EXPECT_EQ(counts.dereferences, n);
+		EXPECT_EQ(counts.comparisons, n + 1);
+		EXPECT_EQ(counts.swaps, 0);
+		EXPECT_EQ(counts.total(), 3 * n + 1);
+	}
+
+
+	TEST_F(StatsTest, Sorting)
+	{
+		it::stats::Scope scope;
+
+		std::sort(ZIP_ALL(v, u));
+
+		EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+		EXPECT_GT(scope.counts().swaps, 0);
+		EXPECT_GT(scope.counts().dereferences, scope.counts().swaps);
+		EXPECT_GT(scope.counts().distances, 0);
+
+
+		it::stats::Scope inner;
+
+		std::reverse(ZIP_ALL(v, u));
+
+		EXPECT_EQ(inner.counts().swaps, n / 2);
+		EXPECT_GE(scope.counts().swaps, inner.counts().swaps + 1);
+	}
+
+
+	TEST_F(StatsTest, Report)
+	{
+		std::ostringstream out;
+
+		{
+			it::stats::Scope scope("advance", &out);
+
+			auto iter = it::zipBegin(v, u);
+
+			iter += 3;
+			iter = iter - 2;
+		}
+
+		EXPECT_EQ(out.str(), "advance: increments: 0  decrements: 0  advances: 2  distances: 0  "
+		                     "dereferences: 0  comparisons: 0  swaps: 0\n");
+	}
+
+
+	TEST_F(StatsTest, ThreadLocal)
+	{
+		it::stats::Scope scope;
+
+		std::thread([&]{ std::for_each(ZIP_ALL(v, u), [](auto){}); }).join();
+
+		EXPECT_EQ(scope.counts().total(), 0);
+	}
+
+
+} // namespace
@@ -0,0 +1,176 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+#include "ZipIter/StringColumn.h"
+
+
+namespace
+{
+	struct StringColumnTest : public ::testing::Test
+	{
+		StringColumnTest () {}
+
+		virtual ~StringColumnTest () { }
+
+		virtual void SetUp ()
+		{
+			const std::vector<std::string> stems = { "", "a", "ab", "abcdefgh", "abcdefghij", "abcdefghik", "zz", std::string("a\0b", 3) };
+
+			for(int i = 0; i < n; ++i)
+			{
+				std::string s = stems[std::uniform_int_distribution<>(0, int(stems.size()) - 1)(gen)];
+
+				if(std::uniform_int_distribution<>(0, 1)(gen))
+					s += std::to_string(std::uniform_int_distribution<>(0, 50)(gen));
+
+				strings.push_back(s);
+				values.push_back(i);
+			}
+
+			column = it::StringColumn(strings.begin(), strings.end());
+		}
+
+		virtual void TearDown () {}
+
+
+		int n = 3000;
+
+		std::vector<std::string> strings;
+		std::vector<int> values;
+
+		it::StringColumn column;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(StringColumnTest, Compare)
+	{
+		for(int k = 0; k < 5000; ++k)
+		{
+			int i = std::uniform_int_distribution<>(0, n - 1)(gen), j = std::uniform_int_distribution<>(0, n - 1)(gen);
+
+			int expected = strings[i].compare(strings[j]);
+
+			EXPECT_EQ(column[i].compare(column[j]) < 0, expected < 0);
+			EXPECT_EQ(column[i].compare(column[j]) > 0, expected > 0);
+			EXPECT_EQ(column[i] == column[j], strings[i] == strings[j]);
+			EXPECT_EQ(column[i] < column[j], strings[i] < strings[j]);
+		}
+
+		EXPECT_LT(it::StringRef("a"), it::StringRef(std::string("a\0", 2)));
+		EXPECT_LT(it::StringRef("abcdefgh"), it::StringRef("abcdefgh0"));
+		EXPECT_EQ(it::StringRef("abcdefghijk"), it::StringRef(std::string("abcdefghijk")));
+		EXPECT_NE(it::StringRef("abcdefghijk"), it::StringRef("abcdefghijz"));
+	}
+
+
+	TEST_F(StringColumnTest, Zip)
+	{
+		ASSERT_EQ(column.size(), strings.size());
+
+		std::size_t bytes = 0;
+		int i = 0;
+
+		for(auto tup : it::zip(column, values))
+		{
+			it::unZip(tup, [&](it::StringRef s, int v)
+			{
+				EXPECT_EQ(s.str(), strings[i]);
+				EXPECT_EQ(v, i);
+
+				bytes += s.size();
+			});
+
+			++i;
+		}
+
+		EXPECT_EQ(i, n);
+		EXPECT_EQ(bytes, column.bytes());
+
+		auto zipped = it::zip(column, values);
+
+		EXPECT_EQ(std::string(std::get<0>(zipped[10])), strings[10]);
+		EXPECT_EQ(std::get<0>(*(zipped.begin() + 7)), it::StringRef(strings[7]));
+	}
+
+
+	TEST_F(StringColumnTest, Sort)
+	{
+		/// The std algorithms can not move the rows of a string column, so they must not compile on it
+		static_assert(!std::is_assignable<decltype(*column.begin()), it::StringRef>::value, "");
+		static_assert(!std::is_assignable<decltype(*it::zipBegin(column, values)), std::tuple<it::StringRef, int>>::value, "");
+
+		auto auxS = strings;
+		auto auxV = values;
+
+		std::stable_sort(ZIP_ALL(auxS, auxV), [](const auto& x, const auto& y){ return std::get<0>(x) < std::get<0>(y); });
+
+		it::ScratchArena arena;
+
+		it::sort(it::zip(column, values), arena);
+
+		EXPECT_EQ(values, auxV);
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(column[i].str(), auxS[i]);
+
+		EXPECT_TRUE(std::is_sorted(column.begin(), column.end()));
+
+
+		auto pred = [](it::StringRef s, int v){ return s.size() < 3 || v % 2; };
+
+		auto mid = std::stable_partition(ZIP_ALL(auxS, auxV), [](const auto& t){ return std::get<0>(t).size() < 3 || std::get<1>(t) % 2; });
+
+		EXPECT_EQ(it::partition(it::zip(column, values), pred, arena), std::size_t(mid - it::zipBegin(auxS, auxV)));
+
+		EXPECT_EQ(values, auxV);
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(column[i].str(), auxS[i]);
+
+
+		/// A string column longer than the first column of the zip: only the rows of the zip move
+		std::vector<int> keys = { 3, 1, 2 };
+
+		it::StringColumn longer = { "c", "a", "b", "abcdefghij", "x", "", "zz", "y" };
+
+		it::sort(it::zip(keys, longer), arena);
+
+		EXPECT_EQ(keys, std::vector<int>({ 1, 2, 3 }));
+
+		std::vector<std::string> longerStrings(longer.begin(), longer.end());
+
+		EXPECT_EQ(longerStrings, std::vector<std::string>({ "a", "b", "c", "abcdefghij", "x", "", "zz", "y" }));
+	}
+
+
+	TEST_F(StringColumnTest, Append)
+	{
+		it::StringColumn col;
+
+		col.reserve(3, 10);
+
+		col.push_back("first");
+		col.append("second", 3);
+		col.push_back(std::string());
+
+		EXPECT_EQ(col.size(), 3u);
+		EXPECT_EQ(col.bytes(), 8u);
+		EXPECT_EQ(col[0], "first");
+		EXPECT_EQ(col[1], "sec");
+		EXPECT_TRUE(col[2].empty());
+
+		col.clear();
+
+		EXPECT_TRUE(col.empty());
+		EXPECT_EQ(col.begin(), col.end());
+	}
+}
@@ -0,0 +1,165 @@
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/TopK.h"
+
+
+namespace
+{
+	struct TopKTest : public ::testing::Test
+	{
+		TopKTest () {}
+
+		virtual ~TopKTest () { }
+
+		virtual void SetUp ()
+		{
+			keys.resize(n);
+			ids.resize(n);
+			vals.resize(n);
+
+			for(int i = 0; i < n; ++i)
+			{
+				keys[i] = std::uniform_int_distribution<>(0, 50)(gen);
+				ids[i] = i;
+				vals[i] = 0.5 * i;
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// The expected result, using a stable sort on all columns
+		template <class Compare>
+		std::vector<int> sortedIds (Compare compare)
+		{
+			std::vector<int> aux = ids;
+
+			std::stable_sort(aux.begin(), aux.end(), [&](int a, int b){ return compare(keys[a], keys[b]); });
+
+			return aux;
+		}
+
+
+		int n = 1000;
+
+		std::vector<int> keys;
+		std::vector<int> ids;
+		std::vector<double> vals;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(TopKTest, SmallK)
+	{
+		auto expected = sortedIds(std::less<>());
+
+		auto res = it::topK(it::zip(keys, ids, vals), 10);
+
+		ASSERT_EQ(std::get<0>(res).size(), 10);
+
+		for(int i = 0; i < 10; ++i)
+		{
+			EXPECT_EQ(std::get<1>(res)[i], expected[i]);
+			EXPECT_EQ(std::get<0>(res)[i], keys[expected[i]]);
+			EXPECT_EQ(std::get<2>(res)[i], vals[expected[i]]);
+		}
+	}
+
+
+	TEST_F(TopKTest, LargeKGreater)
+	{
+		auto expected = sortedIds(std::greater<>());
+
+		auto rows = it::topKRows(it::zip(keys, ids), 600, std::greater<>());
+
+		ASSERT_EQ(rows.size(), 600);
+
+		for(int i = 0; i < 600; ++i)
+			EXPECT_EQ(int(rows[i]), expected[i]);
+
+
+		EXPECT_EQ(it::topKRows(it::zip(keys, ids), 2 * n).size(), n);
+		EXPECT_TRUE(it::topKRows(it::zip(keys, ids), 0).empty());
+	}
+
+
+	TEST_F(TopKTest, PartialSort)
+	{
+		auto expected = sortedIds(std::less<>());
+		auto auxKeys = keys;
+
+		it::partialSort(it::zip(keys, ids, vals), 20);
+
+		for(int i = 0; i < 20; ++i)
+			EXPECT_EQ(ids[i], expected[i]);
+
+		for(int i = 0; i < n; ++i)
+		{
+			EXPECT_EQ(keys[i], auxKeys[ids[i]]);
+			EXPECT_EQ(vals[i], 0.5 * ids[i]);
+		}
+
+		std::vector<int> aux = ids;
+		std::sort(aux.begin(), aux.end());
+
+		for(int i = 0; i < n; ++i)
+			EXPECT_EQ(aux[i], i);
+	}
+
+
+	TEST_F(TopKTest, NthElement)
+	{
+		std::vector<int> sorted = keys;
+		std::sort(sorted.begin(), sorted.end());
+
+		for(int nth : { 0, 7, n / 2, n - 1 })
+		{
+			it::nthElement(it::zip(keys, ids, vals), nth);
+
+			EXPECT_EQ(keys[nth], sorted[nth]);
+
+			for(int i = 0; i < nth; ++i)
+				EXPECT_LE(keys[i], keys[nth]);
+
+			for(int i = nth + 1; i < n; ++i)
+				EXPECT_GE(keys[i], keys[nth]);
+
+			for(int i = 0; i < n; ++i)
+				EXPECT_EQ(vals[i], 0.5 * ids[i]);
+		}
+	}
+
+
+	TEST_F(TopKTest, Streaming)
+	{
+		auto expected = sortedIds(std::greater<>());
+
+		auto top = it::makeTopK<int, int, double>(15, std::greater<>());
+
+		for(int i = 0; i < n; i += 100)
+			top.push(it::zip(std::vector<int>(keys.begin() + i, keys.begin() + i + 100),
+			                 std::vector<int>(ids.begin() + i, ids.begin() + i + 100),
+			                 std::vector<double>(vals.begin() + i, vals.begin() + i + 100)));
+
+		EXPECT_EQ(top.size(), 15);
+		EXPECT_EQ(top.seen(), n);
+
+		auto res = top.result();
+
+		for(int i = 0; i < 15; ++i)
+		{
+			EXPECT_EQ(std::get<1>(res)[i], expected[i]);
+			EXPECT_EQ(std::get<2>(res)[i], vals[expected[i]]);
+		}
+	}
+
+
+} // namespace
@@ -0,0 +1,125 @@
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+#include "ZipIter/Zip2d.h"
+
+
+namespace
+{
+	struct Zip2dTest : public ::testing::Test
+	{
+		Zip2dTest () {}
+
+		virtual ~Zip2dTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < rows * cols; ++i)
+			{
+				a.push_back(std::uniform_real_distribution<>(0.0, 1.0)(gen));
+				b.push_back(i);
+			}
+
+			c.resize(rows * cols);
+		}
+
+		virtual void TearDown () {}
+
+
+		int rows = 300;
+		int cols = 217;
+
+		std::vector<double> a;
+		std::vector<int> b;
+		std::vector<double> c;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(Zip2dTest, Orders)
+	{
+		auto mats = it::zip2d(rows, cols, a, b, c);
+
+		for(auto order : { it::Traversal::rowMajor, it::Traversal::columnMajor, it::Traversal::tiled })
+		{
+			std::vector<int> visits(rows * cols);
+			std::size_t last = 0, count = 0;
+
+			mats.forEach([&](std::size_t i, std::size_t j, double x, int y, double& z)
+			{
+				EXPECT_EQ(y, int(i * cols + j));
+
+				z = x + y;
+				visits[y]++;
+
+				if(order == it::Traversal::rowMajor && count++)
+				{
+					EXPECT_EQ(std::size_t(y), last + 1);
+				}
+
+				if(order == it::Traversal::columnMajor && count++)
+				{
+					EXPECT_EQ(j * rows + i, last + 1);
+				}
+
+				last = order == it::Traversal::columnMajor ? j * rows + i : y;
+
+			}, order);
+
+			for(int v : visits)
+				EXPECT_EQ(v, 1);
+
+			for(int k = 0; k < rows * cols; ++k)
+				EXPECT_EQ(c[k], a[k] + b[k]);
+		}
+
+		EXPECT_EQ(std::get<1>(mats(2, 5)), 2 * cols + 5);
+		EXPECT_GE(mats.blockSide(), mats.tileSide());
+		EXPECT_EQ(mats.blockSide() % mats.tileSide(), 0u);
+	}
+
+
+	TEST_F(Zip2dTest, Transpose)
+	{
+		std::vector<double> t(rows * cols);
+
+		it::zip2d(rows, cols, a).forEach([&](std::size_t i, std::size_t j, double x)
+		{
+			t[j * rows + i] = x;
+		});
+
+		for(int i = 0; i < rows; ++i)
+			for(int j = 0; j < cols; ++j)
+				EXPECT_EQ(t[j * rows + i], a[i * cols + j]);
+
+
+		std::vector<double> u(rows * cols);
+
+		it::zip2d(rows, cols, a).forEachTiled([&](std::size_t i, std::size_t j, double x)
+		{
+			u[j * rows + i] = x;
+
+		}, 7, 21);
+
+		EXPECT_EQ(t, u);
+	}
+
+
+	TEST_F(Zip2dTest, Errors)
+	{
+		EXPECT_THROW(it::zip2d(rows + 1, cols, a, b), std::runtime_error);
+		EXPECT_THROW(it::zip2d(rows, cols, a).forEachTiled([](std::size_t, std::size_t, double){}, 16, 8), std::runtime_error);
+
+		int count = 0;
+
+		it::zip2d(0, cols, a).forEach([&](std::size_t, std::size_t, double){ ++count; });
+
+		EXPECT_EQ(count, 0);
+	}
+}
@@ -0,0 +1,134 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "ZipIter/ZoneMap.h"
+
+
+namespace
+{
+	struct ZoneMapTest : public ::testing::Test
+	{
+		ZoneMapTest () {}
+
+		virtual ~ZoneMapTest () { }
+
+		virtual void SetUp ()
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				time.push_back(10 * i + std::uniform_int_distribution<>(-30, 30)(gen));
+				value.push_back(0.5 * i);
+				name.push_back(std::to_string(i));
+			}
+		}
+
+		virtual void TearDown () {}
+
+
+		/// The rows matched by a plain scan
+		std::vector<int> expected (long long lo, long long hi)
+		{
+			std::vector<int> rows;
+
+			for(int i = 0; i < int(time.size()); ++i)
+				if(lo <= time[i] && time[i] <= hi)
+					rows.push_back(i);
+
+			return rows;
+		}
+
+
+		int n = 20000;
+
+		std::vector<long long> time;
+		std::vector<double> value;
+		std::vector<std::string> name;
+
+		std::mt19937 gen;
+	};
+
+
+
+
+
+	TEST_F(ZoneMapTest, MinMax)
+	{
+		auto zones = it::makeZoneMap(it::zip(time, value), 1000);
+
+		ASSERT_EQ(zones.blocks(), 20u);
+
+		for(std::size_t b = 0; b < zones.blocks(); ++b)
+		{
+			EXPECT_EQ(zones.min(b), *std::min_element(time.begin() + 1000 * b, time.begin() + 1000 * (b + 1)));
+			EXPECT_EQ(zones.max(b), *std::max_element(time.begin() + 1000 * b, time.begin() + 1000 * (b + 1)));
+		}
+	}
+
+
+	TEST_F(ZoneMapTest, Scan)
+	{
+		auto zipped = it::zip(time, value, name);
+
+		it::ZoneMap<long long> zones(time, 256);
+
+		for(auto range : { std::make_pair(-100, -1), std::make_pair(0, 100), std::make_pair(5000, 7000),
+		                   std::make_pair(-100, 300000), std::make_pair(199950, 300000) })
+		{
+			std::vector<int> rows;
+
+			std::size_t count = it::scanRange(zipped, zones, range.first, range.second, [&](long long t, double v, const std::string& s)
+			{
+				EXPECT_TRUE(range.first <= t && t <= range.second);
+				EXPECT_EQ(std::to_string(int(2 * v)), s);
+
+				rows.push_back(std::stoi(s));
+			});
+
+			EXPECT_EQ(rows, expected(range.first, range.second));
+			EXPECT_EQ(count, rows.size());
+		}
+
+
+		/// A selective query visits only a few blocks
+		std::size_t visited = zones.forEachCandidate(50000, 51000, [](std::size_t, std::size_t, bool){});
+
+		EXPECT_LE(visited, 4u * 256);
+	}
+
+
+	TEST_F(ZoneMapTest, Update)
+	{
+		std::vector<long long> t(time.begin(), time.begin() + 1500);
+		std::vector<double> v(value.begin(), value.begin() + 1500);
+
+		auto zones = it::makeZoneMap(it::zip(t, v), 1000);
+
+		t.insert(t.end(), time.begin() + 1500, time.end());
+		v.insert(v.end(), value.begin() + 1500, value.end());
+
+		t.push_back(-5);
+		v.push_back(-1.0);
+
+		zones.update(t);
+
+		it::ZoneMap<long long> fresh(t, 1000);
+
+		ASSERT_EQ(zones.size(), t.size());
+		ASSERT_EQ(zones.blocks(), fresh.blocks());
+
+		for(std::size_t b = 0; b < zones.blocks(); ++b)
+		{
+			EXPECT_EQ(zones.min(b), fresh.min(b));
+			EXPECT_EQ(zones.max(b), fresh.max(b));
+		}
+
+		std::vector<double> found;
+
+		it::scanRange(it::zip(t, v), zones, -10, -1, [&](long long, double x){ found.push_back(x); });
+
+		EXPECT_EQ(found, std::vector<double>({ -1.0 }));
+	}
+}